@@ -2,12 +2,18 @@
 #include <absl/container/btree_map.h>
 #include <absl/strings/string_view.h>
 #include <fstream>
+#include <sstream>
 #include <vector>
+#include <algorithm>
 #include <string>
 #include <random>
 #include <iostream>
+#include <cstdlib>
+#include <memory>
 #include <sys/resource.h>
 #include "radix/tree.hpp"
+#include "radix/mapped_tree.hpp"
+#include "radix/durable_tree.hpp"
 
 // Forward declarations
 size_t GetCurrentMemoryUsage();
@@ -64,20 +70,21 @@ void LoadWords() {
 void InitializeData(Tree<std::string, std::string>& radix_tree) {
     std::ifstream file("words.txt");
     std::string word;
+    std::vector<std::pair<std::string, std::string>> entries;
     int count = 0;
     
     while (std::getline(file, word)) {
         if (!word.empty()) {
             words.push_back(word);
-            auto [new_tree, old_val, updated] = radix_tree.insert(word, word);
-            radix_tree = new_tree;
+            entries.emplace_back(word, word);
             btree_map[word] = word;
             count++;
             if (count % 10000 == 0) {
-                std::cout << "Inserted " << count << " words..." << std::endl;
+                std::cout << "Read " << count << " words..." << std::endl;
             }
         }
     }
+    radix_tree.insertBatch(entries);
     
     std::cout << "Total words inserted: " << count << std::endl;
 }
@@ -145,6 +152,118 @@ static void BM_RadixTreeInsert(benchmark::State& state) {
 }
 BENCHMARK(BM_RadixTreeInsert);
 
+// Benchmark: Insert all words into radix tree as one batch, in file order
+static void BM_RadixTreeInsertBatch(benchmark::State& state) {
+    std::vector<std::pair<std::string, std::string>> entries;
+    entries.reserve(words.size());
+    for (const auto& word : words) {
+        entries.emplace_back(word, word);
+    }
+    
+    for (auto _ : state) {
+        Tree<std::string, std::string> tree;
+        int inserted = tree.insertBatch(entries);
+        benchmark::DoNotOptimize(inserted);
+        benchmark::DoNotOptimize(tree);
+    }
+    
+    state.SetItemsProcessed(state.iterations() * words.size());
+    state.SetBytesProcessed(state.iterations() * words.size() * sizeof(std::string) * 2);
+}
+BENCHMARK(BM_RadixTreeInsertBatch);
+
+// Benchmark: Build the radix tree from all words in one sorted pass
+static void BM_RadixTreeFromSorted(benchmark::State& state) {
+    std::vector<std::pair<std::string, std::string>> sorted;
+    sorted.reserve(words.size());
+    for (const auto& word : words) {
+        sorted.emplace_back(word, word);
+    }
+    std::sort(sorted.begin(), sorted.end());
+    
+    for (auto _ : state) {
+        auto tree = Tree<std::string, std::string>::fromSorted(sorted.begin(), sorted.end());
+        benchmark::DoNotOptimize(tree);
+    }
+    
+    state.SetItemsProcessed(state.iterations() * words.size());
+    state.SetBytesProcessed(state.iterations() * words.size() * sizeof(std::string) * 2);
+}
+BENCHMARK(BM_RadixTreeFromSorted);
+
+// Benchmark: Write the radix tree to a stream, as a checkpoint would
+static void BM_RadixTreeSerialize(benchmark::State& state) {
+    for (auto _ : state) {
+        std::stringstream stream;
+        radix_tree.serialize(stream);
+        benchmark::DoNotOptimize(stream);
+    }
+    
+    state.SetItemsProcessed(state.iterations() * words.size());
+}
+BENCHMARK(BM_RadixTreeSerialize);
+
+// Benchmark: Rebuild the radix tree from a serialized stream
+static void BM_RadixTreeDeserialize(benchmark::State& state) {
+    std::stringstream stream;
+    radix_tree.serialize(stream);
+    std::string bytes = stream.str();
+    
+    for (auto _ : state) {
+        std::istringstream in(bytes);
+        auto tree = Tree<std::string, std::string>::deserialize(in);
+        benchmark::DoNotOptimize(tree);
+    }
+    
+    state.SetItemsProcessed(state.iterations() * words.size());
+    state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+BENCHMARK(BM_RadixTreeDeserialize);
+
+// Benchmark: Logged inserts into a durable tree from state.threads() writers,
+// which share syncs through group commit
+static std::unique_ptr<DurableTree<std::string, std::string>> durable_tree;
+
+static void BM_DurableTreeInsert(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        int status = std::system("rm -rf words.wal");
+        (void)status;
+        durable_tree = DurableTree<std::string, std::string>::open("words.wal");
+    }
+    
+    size_t i = state.thread_index();
+    for (auto _ : state) {
+        durable_tree->insert(words[i % words.size()], words[i % words.size()]);
+        i += state.threads();
+    }
+    
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        state.counters["syncs"] = durable_tree->syncCount();
+        durable_tree.reset();
+    }
+}
+BENCHMARK(BM_DurableTreeInsert)->Threads(1)->Threads(8)->Threads(32)->UseRealTime();
+
+// Benchmark: Build the radix tree from all words, unsorted, on range(0) threads
+static void BM_RadixTreeFromUnsorted(benchmark::State& state) {
+    std::vector<std::pair<std::string, std::string>> entries;
+    entries.reserve(words.size());
+    for (const auto& word : words) {
+        entries.emplace_back(word, word);
+    }
+    std::shuffle(entries.begin(), entries.end(), std::mt19937(42));
+    
+    for (auto _ : state) {
+        auto tree = Tree<std::string, std::string>::fromUnsorted(entries, static_cast<unsigned>(state.range(0)));
+        benchmark::DoNotOptimize(tree);
+    }
+    
+    state.SetItemsProcessed(state.iterations() * words.size());
+    state.SetBytesProcessed(state.iterations() * words.size() * sizeof(std::string) * 2);
+}
+BENCHMARK(BM_RadixTreeFromUnsorted)->Arg(1)->Arg(4)->Arg(16)->UseRealTime();
+
 // Benchmark: Insert all words into btree_map
 static void BM_BTreeMapInsert(benchmark::State& state) {
     size_t start_memory = GetCurrentMemoryUsage();
@@ -204,6 +323,100 @@ static void BM_RadixTreeLookup(benchmark::State& state) {
 }
 BENCHMARK(BM_RadixTreeLookup);
 
+// Benchmark: Rank of every word, counted from the per-node key counts
+static void BM_RadixTreeRank(benchmark::State& state) {
+    for (auto _ : state) {
+        for (const auto& word : words) {
+            auto result = radix_tree.rank(word);
+            benchmark::DoNotOptimize(result);
+        }
+    }
+    
+    state.SetItemsProcessed(state.iterations() * words.size());
+}
+BENCHMARK(BM_RadixTreeRank);
+
+// Benchmark: Scan 10 keys from the lower bound of each word
+static void BM_RadixTreeRangeScan(benchmark::State& state) {
+    for (auto _ : state) {
+        for (const auto& word : words) {
+            auto it = radix_tree.iterator();
+            it.seekLowerBound(word);
+            for (int i = 0; i < 10; i++) {
+                auto result = it.next();
+                benchmark::DoNotOptimize(result);
+            }
+        }
+    }
+    
+    state.SetItemsProcessed(state.iterations() * words.size());
+}
+BENCHMARK(BM_RadixTreeRangeScan);
+
+// Benchmark: The same scans in btree_map
+static void BM_BTreeMapRangeScan(benchmark::State& state) {
+    for (auto _ : state) {
+        for (const auto& word : words) {
+            auto it = btree_map.lower_bound(word);
+            for (int i = 0; i < 10 && it != btree_map.end(); i++, ++it) {
+                benchmark::DoNotOptimize(it->second);
+            }
+        }
+    }
+    
+    state.SetItemsProcessed(state.iterations() * words.size());
+}
+BENCHMARK(BM_BTreeMapRangeScan);
+
+// Benchmark: Lookup all words in radix tree in batches with multiGet, to
+// compare against the per-key loop above
+static void BM_RadixTreeMultiGet(benchmark::State& state) {
+    size_t batch = state.range(0);
+    std::vector<std::optional<std::string>> out(batch);
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < words.size(); i += batch) {
+            size_t n = std::min(batch, words.size() - i);
+            radix_tree.multiGet(words.data() + i, n, out.data());
+            benchmark::DoNotOptimize(out.data());
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * words.size());
+    state.SetBytesProcessed(state.iterations() * words.size() * sizeof(std::string));
+}
+BENCHMARK(BM_RadixTreeMultiGet)->Arg(16)->Arg(64);
+
+// Benchmark: Lookup all words in a mapped image of the radix tree
+static void BM_MappedTreeLookup(benchmark::State& state) {
+    MappedTree<std::string, std::string>::write(radix_tree, "words.img");
+    auto mapped = MappedTree<std::string, std::string>::open("words.img");
+    
+    for (auto _ : state) {
+        for (const auto& word : words) {
+            auto result = mapped->Get(word);
+            benchmark::DoNotOptimize(result);
+        }
+    }
+    
+    state.SetItemsProcessed(state.iterations() * words.size());
+    state.SetBytesProcessed(state.iterations() * words.size() * sizeof(std::string));
+}
+BENCHMARK(BM_MappedTreeLookup);
+
+// Benchmark: Open the mapped image and look up one word, the cold start
+// that replaces loading words.txt into a tree
+static void BM_MappedTreeOpen(benchmark::State& state) {
+    MappedTree<std::string, std::string>::write(radix_tree, "words.img");
+    
+    for (auto _ : state) {
+        auto mapped = MappedTree<std::string, std::string>::open("words.img");
+        auto result = mapped->Get(words[words.size() / 2]);
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_MappedTreeOpen);
+
 // Benchmark: Lookup all words in btree_map
 static void BM_BTreeMapLookup(benchmark::State& state) {
     size_t start_memory = GetCurrentMemoryUsage();
@@ -230,6 +443,65 @@ static void BM_BTreeMapLookup(benchmark::State& state) {
 }
 BENCHMARK(BM_BTreeMapLookup);
 
+// Benchmark: LongestPrefix for all words in radix tree
+static void BM_RadixTreeLongestPrefix(benchmark::State& state) {
+    for (auto _ : state) {
+        for (const auto& word : words) {
+            auto result = radix_tree.LongestPrefix(word);
+            benchmark::DoNotOptimize(result);
+        }
+    }
+    
+    state.SetItemsProcessed(state.iterations() * words.size());
+    state.SetBytesProcessed(state.iterations() * words.size() * sizeof(std::string));
+}
+BENCHMARK(BM_RadixTreeLongestPrefix);
+
+// Benchmark: findMatchingPrefixes for all words in radix tree
+static void BM_RadixTreeFindMatchingPrefixes(benchmark::State& state) {
+    for (auto _ : state) {
+        for (const auto& word : words) {
+            auto result = radix_tree.findMatchingPrefixes(word);
+            benchmark::DoNotOptimize(result);
+        }
+    }
+    
+    state.SetItemsProcessed(state.iterations() * words.size());
+    state.SetBytesProcessed(state.iterations() * words.size() * sizeof(std::string));
+}
+BENCHMARK(BM_RadixTreeFindMatchingPrefixes);
+
+// Benchmark: The same prefixes visited with walkPath, nothing collected
+static void BM_RadixTreeWalkPath(benchmark::State& state) {
+    for (auto _ : state) {
+        for (const auto& word : words) {
+            int count = 0;
+            radix_tree.walkPath(word, [&](KeyView<char>, const std::string&) { count++; });
+            benchmark::DoNotOptimize(count);
+        }
+    }
+    
+    state.SetItemsProcessed(state.iterations() * words.size());
+}
+BENCHMARK(BM_RadixTreeWalkPath);
+
+// Benchmark: The same prefixes stepped through with prefixIterator
+static void BM_RadixTreePrefixIterator(benchmark::State& state) {
+    for (auto _ : state) {
+        for (const auto& word : words) {
+            int count = 0;
+            auto it = radix_tree.prefixIterator(word);
+            while (it.nextLeaf()) {
+                count++;
+            }
+            benchmark::DoNotOptimize(count);
+        }
+    }
+    
+    state.SetItemsProcessed(state.iterations() * words.size());
+}
+BENCHMARK(BM_RadixTreePrefixIterator);
+
 // Benchmark: Iterate through all words in radix tree
 static void BM_RadixTreeIterate(benchmark::State& state) {
     size_t start_memory = GetCurrentMemoryUsage();
@@ -252,6 +524,36 @@ static void BM_RadixTreeIterate(benchmark::State& state) {
 }
 BENCHMARK(BM_RadixTreeIterate);
 
+// Benchmark: Iterate through all words with next(), which copies each key
+// and value, to compare against the range-for above
+static void BM_RadixTreeIterateNext(benchmark::State& state) {
+    for (auto _ : state) {
+        int count = 0;
+        auto it = radix_tree.iterator();
+        for (auto res = it.next(); res.found; res = it.next()) {
+            benchmark::DoNotOptimize(res);
+            count++;
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    
+    state.SetItemsProcessed(state.iterations() * words.size());
+}
+BENCHMARK(BM_RadixTreeIterateNext);
+
+// Benchmark: Sum the value lengths of all words with parallelReduce
+static void BM_RadixTreeParallelReduce(benchmark::State& state) {
+    auto fold = [](size_t acc, KeyView<char>, const std::string& value) { return acc + value.size(); };
+    auto combine = [](size_t a, size_t b) { return a + b; };
+    for (auto _ : state) {
+        size_t total = radix_tree.parallelReduce(size_t(0), fold, combine, static_cast<unsigned>(state.range(0)));
+        benchmark::DoNotOptimize(total);
+    }
+    
+    state.SetItemsProcessed(state.iterations() * words.size());
+}
+BENCHMARK(BM_RadixTreeParallelReduce)->Arg(1)->Arg(4)->Arg(16)->UseRealTime();
+
 // Benchmark: Iterate through all words in btree_map
 static void BM_BTreeMapIterate(benchmark::State& state) {
     size_t start_memory = GetCurrentMemoryUsage();
@@ -0,0 +1,133 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+#include <string>
+#include <random>
+#include <iostream>
+#include "radix/tree.hpp"
+
+// Micro-benchmarks for the byte comparison kernels behind hasPrefix and
+// longestPrefix. Each benchmark compares two equal buffers of range(0) bytes,
+// which is the worst case: the kernel has to scan the whole length.
+
+static std::string makeBytes(size_t len) {
+    std::mt19937 rng(42);
+    std::string s(len, '\0');
+    for (auto& c : s) {
+        c = static_cast<char>('a' + rng() % 26);
+    }
+    return s;
+}
+
+template<size_t (*Kernel)(const void*, const void*, size_t)>
+static void BM_Mismatch(benchmark::State& state) {
+    size_t len = static_cast<size_t>(state.range(0));
+    std::string a = makeBytes(len);
+    std::string b = a;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Kernel(a.data(), b.data(), len));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * len);
+}
+
+static void BM_MismatchScalar(benchmark::State& state) {
+    BM_Mismatch<mismatchBytesScalar>(state);
+}
+
+static void BM_MismatchSSE2(benchmark::State& state) {
+#if !defined(__x86_64__) && !defined(__i386__)
+    state.SkipWithError("SSE2 is only available on x86");
+    return;
+#endif
+    BM_Mismatch<mismatchBytesSSE2>(state);
+}
+
+static void BM_MismatchAVX2(benchmark::State& state) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (!__builtin_cpu_supports("avx2")) {
+        state.SkipWithError("CPU does not support AVX2");
+        return;
+    }
+#else
+    state.SkipWithError("AVX2 is only available on x86");
+    return;
+#endif
+    BM_Mismatch<mismatchBytesAVX2>(state);
+}
+
+static void BM_MismatchNEON(benchmark::State& state) {
+#if !defined(__ARM_NEON) || !defined(__aarch64__)
+    state.SkipWithError("NEON is only available on arm64");
+    return;
+#endif
+    BM_Mismatch<mismatchBytesNEON>(state);
+}
+
+static void BM_MismatchDispatched(benchmark::State& state) {
+    state.SetLabel(mismatchKernelName());
+    BM_Mismatch<mismatchBytes>(state);
+}
+
+// std::mismatch is the byte-at-a-time loop the kernels replace
+static void BM_MismatchStd(benchmark::State& state) {
+    size_t len = static_cast<size_t>(state.range(0));
+    std::string a = makeBytes(len);
+    std::string b = a;
+    for (auto _ : state) {
+        auto it = std::mismatch(a.begin(), a.end(), b.begin());
+        benchmark::DoNotOptimize(it.first - a.begin());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * len);
+}
+
+static void BM_LongestPrefixString(benchmark::State& state) {
+    size_t len = static_cast<size_t>(state.range(0));
+    std::string a = makeBytes(len);
+    std::string b = a;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(longestPrefix(a, b));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * len);
+}
+
+static void BM_LongestPrefixBytes(benchmark::State& state) {
+    size_t len = static_cast<size_t>(state.range(0));
+    std::string s = makeBytes(len);
+    std::vector<uint8_t> a(s.begin(), s.end());
+    std::vector<uint8_t> b = a;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(longestPrefix(a, b));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * len);
+}
+
+static void BM_HasPrefixKeyView(benchmark::State& state) {
+    size_t len = static_cast<size_t>(state.range(0));
+    std::string a = makeBytes(len);
+    std::string b = a;
+    KeyView<char> view(a.data(), a.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(hasPrefix(view, b));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * len);
+}
+
+#define KERNEL_LENGTHS Arg(8)->Arg(32)->Arg(64)->Arg(256)
+
+BENCHMARK(BM_MismatchStd)->KERNEL_LENGTHS;
+BENCHMARK(BM_MismatchScalar)->KERNEL_LENGTHS;
+BENCHMARK(BM_MismatchSSE2)->KERNEL_LENGTHS;
+BENCHMARK(BM_MismatchAVX2)->KERNEL_LENGTHS;
+BENCHMARK(BM_MismatchNEON)->KERNEL_LENGTHS;
+BENCHMARK(BM_MismatchDispatched)->KERNEL_LENGTHS;
+BENCHMARK(BM_LongestPrefixString)->KERNEL_LENGTHS;
+BENCHMARK(BM_LongestPrefixBytes)->KERNEL_LENGTHS;
+BENCHMARK(BM_HasPrefixKeyView)->KERNEL_LENGTHS;
+
+int main(int argc, char** argv) {
+    std::cout << "Dispatched mismatch kernel: " << mismatchKernelName() << std::endl;
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
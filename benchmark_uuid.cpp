@@ -7,12 +7,17 @@
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <memory>
+#include <optional>
+#include <thread>
 #include "radix/tree.hpp"
+#include "radix/olc_tree.hpp"
 
 // Global data for benchmarks
 std::vector<std::string> uuids;
 Tree<std::string, std::string> radix_tree;
 absl::btree_map<std::string, std::string> btree_map;
+std::unique_ptr<OlcTree<std::string, std::string>> olc_tree;
 
 // Generate a random UUID
 std::string GenerateUUID() {
@@ -162,6 +167,58 @@ static void BM_BTreeMapUUIDRandomAccess(benchmark::State& state) {
 }
 BENCHMARK(BM_BTreeMapUUIDRandomAccess);
 
+// Benchmark: Concurrent UUID inserts into an OlcTree, 1 to N threads. Each
+// run starts from an empty tree and every thread writes its own share of
+// the UUIDs, as sessions would be created by independent workers.
+static void BM_OlcTreeUUIDInsert(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        olc_tree = std::make_unique<OlcTree<std::string, std::string>>();
+    }
+    std::optional<OlcTree<std::string, std::string>::Writer> writer;
+    size_t next = state.thread_index();
+
+    for (auto _ : state) {
+        if (!writer) {
+            writer.emplace(olc_tree->writer());
+        }
+        for (int i = 0; i < 1000; ++i) {
+            const auto& uuid = uuids[next % uuids.size()];
+            writer->insert(uuid, uuid);
+            next += state.threads();
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * 1000);
+}
+BENCHMARK(BM_OlcTreeUUIDInsert)->ThreadRange(1, std::max(1u, std::thread::hardware_concurrency()))->UseRealTime();
+
+// Benchmark: Concurrent random UUID lookups in an OlcTree, 1 to N threads
+static void BM_OlcTreeUUIDLookup(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        olc_tree = std::make_unique<OlcTree<std::string, std::string>>();
+        auto writer = olc_tree->writer();
+        for (const auto& uuid : uuids) {
+            writer.insert(uuid, uuid);
+        }
+    }
+    std::optional<OlcTree<std::string, std::string>::Reader> reader;
+    std::mt19937 gen(state.thread_index());
+    std::uniform_int_distribution<> dis(0, uuids.size() - 1);
+
+    for (auto _ : state) {
+        if (!reader) {
+            reader.emplace(olc_tree->reader());
+        }
+        for (int i = 0; i < 1000; ++i) {
+            auto result = reader->Get(uuids[dis(gen)]);
+            benchmark::DoNotOptimize(result);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * 1000);
+}
+BENCHMARK(BM_OlcTreeUUIDLookup)->ThreadRange(1, std::max(1u, std::thread::hardware_concurrency()))->UseRealTime();
+
 int main(int argc, char** argv) {
     // Parse command line arguments for UUID count
     int uuid_count = 100000; // Default 100k UUIDs
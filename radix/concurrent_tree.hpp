@@ -0,0 +1,308 @@
+//
+// Created by Ashesh Vidyut on 22/03/25.
+//
+
+#ifndef CONCURRENT_TREE_H
+#define CONCURRENT_TREE_H
+
+#include "tree.hpp"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// EpochManager tells a writer when memory it unpublished can no longer be
+// in use by a reader. Each reader thread owns a slot and, while it reads,
+// stores the global epoch it started in. An object retired in epoch e is
+// freed once every reader in a slot started after e.
+class EpochManager {
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{0};  // 0 while the reader is idle
+        std::atomic<bool> claimed{false};
+        Slot* next = nullptr;
+    };
+
+    std::atomic<uint64_t> globalEpoch{1};
+    std::atomic<Slot*> slots{nullptr};
+
+public:
+    EpochManager() = default;
+    EpochManager(const EpochManager&) = delete;
+    EpochManager& operator=(const EpochManager&) = delete;
+
+    ~EpochManager() {
+        auto slot = slots.load();
+        while (slot) {
+            auto next = slot->next;
+            delete slot;
+            slot = next;
+        }
+    }
+
+    // Reader is a thread's registration. Slots are reused once their
+    // reader goes away, and never freed before the manager.
+    class Reader {
+    private:
+        Slot* slot;
+        EpochManager* manager;
+        int depth = 0;  // nested reads only pin the outermost one
+
+    public:
+        explicit Reader(EpochManager& m) : slot(m.claimSlot()), manager(&m) {}
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        Reader(Reader&& other) noexcept : slot(other.slot), manager(other.manager), depth(other.depth) {
+            other.slot = nullptr;
+        }
+
+        ~Reader() {
+            if (slot) {
+                slot->epoch.store(0);
+                slot->claimed.store(false);
+            }
+        }
+
+        // Marks the start of a read; nothing retired from now on is freed
+        // until exit()
+        void enter() {
+            if (depth++ == 0) {
+                slot->epoch.store(manager->globalEpoch.load());
+            }
+        }
+
+        void exit() {
+            if (--depth == 0) {
+                slot->epoch.store(0, std::memory_order_release);
+            }
+        }
+    };
+
+    // Current epoch. An object unlinked before this is read may be tagged
+    // with it, provided a seq_cst fence separates the unlink from the read.
+    uint64_t current() const {
+        return globalEpoch.load();
+    }
+
+    // Returns the epoch objects unpublished now are retired in, and starts
+    // the next one
+    uint64_t advance() {
+        return globalEpoch.fetch_add(1);
+    }
+
+    // Oldest epoch a reader is still in, or UINT64_MAX if none is reading
+    uint64_t oldestActive() const {
+        uint64_t oldest = UINT64_MAX;
+        for (auto slot = slots.load(); slot; slot = slot->next) {
+            uint64_t e = slot->epoch.load();
+            if (e != 0 && e < oldest) {
+                oldest = e;
+            }
+        }
+        return oldest;
+    }
+
+private:
+    Slot* claimSlot() {
+        for (auto slot = slots.load(); slot; slot = slot->next) {
+            bool expected = false;
+            if (!slot->claimed.load() && slot->claimed.compare_exchange_strong(expected, true)) {
+                return slot;
+            }
+        }
+        auto slot = new Slot();
+        slot->claimed.store(true);
+        slot->next = slots.load();
+        while (!slots.compare_exchange_weak(slot->next, slot)) {
+        }
+        return slot;
+    }
+};
+
+// ConcurrentTree serves lock-free reads from any number of threads while
+// one writer at a time updates it. The writer applies its changes to a
+// private Tree, which copies the paths it changes rather than touching
+// nodes a published version can reach, and then publishes the new version
+// with a single atomic pointer swap. Readers never copy a Tree or touch a
+// reference count: they pin the current epoch and read the published
+// version in place. An unpublished version is released by the writer once
+// every reader that could have seen it has finished.
+template<typename K, typename T>
+class ConcurrentTree {
+private:
+    struct Published {
+        Tree<K, T> tree;
+        uint64_t retiredIn;
+    };
+
+    EpochManager epochs;
+    std::atomic<Published*> current;
+    std::mutex writeMutex;
+    Tree<K, T> master;                  // the writer's tree, guarded by writeMutex
+    std::vector<Published*> retired;    // unpublished versions, guarded by writeMutex
+
+    // Publishes the master tree and frees the versions no reader can see
+    void publish() {
+        auto old = current.exchange(new Published{master, 0});
+        old->retiredIn = epochs.advance();
+        retired.push_back(old);
+        reclaim();
+    }
+
+    void reclaim() {
+        uint64_t oldest = epochs.oldestActive();
+        size_t kept = 0;
+        for (auto p : retired) {
+            if (p->retiredIn < oldest) {
+                delete p;
+            } else {
+                retired[kept++] = p;
+            }
+        }
+        retired.resize(kept);
+    }
+
+public:
+    ConcurrentTree() : current(nullptr) {
+        current.store(new Published{master, 0});
+    }
+
+    // Takes over a tree built beforehand, e.g. with Tree::fromSorted
+    explicit ConcurrentTree(Tree<K, T> initial) : current(nullptr), master(std::move(initial)) {
+        current.store(new Published{master, 0});
+    }
+
+    ConcurrentTree(const ConcurrentTree&) = delete;
+    ConcurrentTree& operator=(const ConcurrentTree&) = delete;
+
+    // No reader may outlive the tree
+    ~ConcurrentTree() {
+        for (auto p : retired) {
+            delete p;
+        }
+        delete current.load();
+    }
+
+    // View is a pinned, consistent version of the tree. It stays valid,
+    // whatever the writer does, until the view is destroyed. Views are
+    // meant to be short lived: a view that is kept holds back the release
+    // of every version unpublished after it was taken.
+    class View {
+    private:
+        EpochManager::Reader* reader;
+        const Tree<K, T>* tree;
+
+        friend class ConcurrentTree;
+
+        View(EpochManager::Reader& r, const std::atomic<Published*>& current) : reader(&r) {
+            reader->enter();
+            tree = &current.load()->tree;
+        }
+
+    public:
+        View(const View&) = delete;
+        View& operator=(const View&) = delete;
+
+        ~View() {
+            reader->exit();
+        }
+
+        int len() const {
+            return tree->len();
+        }
+
+        std::optional<T> Get(KeyViewOf<K> search) const {
+            return tree->Get(search);
+        }
+
+        std::optional<T> Get(const K& search) const {
+            return tree->Get(search);
+        }
+
+        LongestPrefixResult<K, T> LongestPrefix(KeyViewOf<K> search) const {
+            return tree->LongestPrefix(search);
+        }
+
+        LongestPrefixResult<K, T> LongestPrefix(const K& search) const {
+            return tree->LongestPrefix(search);
+        }
+
+        std::tuple<K, T, bool> GetAtIndex(int index) const {
+            return tree->GetAtIndex(index);
+        }
+
+        std::vector<std::pair<K, T>> findMatchingPrefixes(KeyViewOf<K> search) const {
+            return tree->findMatchingPrefixes(search);
+        }
+
+        std::vector<std::pair<K, T>> findMatchingPrefixes(const K& search) const {
+            return tree->findMatchingPrefixes(search);
+        }
+
+        PrefixIterator<K, T> prefixIterator(KeyViewOf<K> key) const {
+            return tree->prefixIterator(key);
+        }
+
+        // Ordered iteration walks the nodes, not the leaf list, which
+        // belongs to the writer
+        NodeIterator<K, T> iterator() const {
+            return NodeIterator<K, T>(tree->getRoot());
+        }
+    };
+
+    // Reader registers the calling thread. Create one per reader thread and
+    // keep it; taking a view through it is then two atomic stores.
+    class Reader {
+    private:
+        EpochManager::Reader slot;
+        const std::atomic<Published*>* current;
+
+        friend class ConcurrentTree;
+
+        explicit Reader(ConcurrentTree& t) : slot(t.epochs), current(&t.current) {}
+
+    public:
+        View view() {
+            return View(slot, *current);
+        }
+    };
+
+    Reader reader() {
+        return Reader(*this);
+    }
+
+    // Applies fn to a transaction on the writer's tree and publishes the
+    // result once, so a batch of writes costs one path copy per node touched
+    template<typename F>
+    void update(F&& fn) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        auto txn = master.txn();
+        fn(txn);
+        txn.commit();
+        publish();
+    }
+
+    std::optional<T> insert(const K& k, const T& v) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        auto [tree, oldVal, didUpdate] = master.insert(k, v);
+        publish();
+        return oldVal;
+    }
+
+    std::optional<T> del(const K& k) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        auto [tree, oldVal, found] = master.del(k);
+        publish();
+        return oldVal;
+    }
+
+    int deletePrefix(const K& k) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        auto [tree, deleted, numDeletions] = master.deletePrefix(k);
+        publish();
+        return numDeletions;
+    }
+};
+
+#endif // CONCURRENT_TREE_H
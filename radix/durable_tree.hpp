@@ -0,0 +1,516 @@
+//
+// Created by Ashesh Vidyut on 22/03/25.
+//
+
+#ifndef DURABLE_TREE_H
+#define DURABLE_TREE_H
+
+#include "tree.hpp"
+#include "value_codec.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// DurableTree keeps a Tree in memory and makes its writes survive a crash.
+// Each write is applied to the tree and appended to a write-ahead log in a
+// directory of its own; the call returns once the log record is on disk.
+//
+// Writes that arrive while the log is being synced are committed together:
+// the first writer to find the log idle becomes the leader, writes every
+// record queued so far as one frame and syncs it once, then wakes the
+// writers it covered. While it syncs, the next group queues up behind it,
+// so under load the number of syncs grows with the number of groups, not
+// the number of writes.
+//
+// The directory holds a snapshot and the logs written since:
+//
+//   snapshot   "RADIXSNP" uint64_t(gen) tree in Tree::serialize format
+//   wal.<gen>  frames of uint32_t(length) uint64_t(checksum) records
+//   record     op varint(keyLen) key [varint(valueLen) value]
+//
+// Once the logs grow past Options::checkpointBytes the writer that crossed
+// the limit starts a new log, writes a snapshot of the tree as of the
+// switch and deletes the logs it covers. The snapshot is written outside
+// the lock, so other writers carry on meanwhile. open() loads the snapshot
+// and replays the logs after it, each up to its first torn or corrupted
+// frame, which is how a crash mid-write leaves it.
+//
+// Writes are visible to readers as soon as they are applied, before they
+// are durable. A log that cannot be written fails the tree: the failing
+// writes and every later one return false, and the tree is left as it was
+// last recovered plus what the failed writes applied.
+template<typename K, typename T>
+class DurableTree {
+public:
+    struct Options {
+        bool sync = true;                       // sync each group; off leaves it to the OS
+        uint64_t checkpointBytes = 64u << 20;   // log size that triggers a checkpoint, 0 for never
+    };
+
+private:
+    using C = typename K::value_type;
+    static_assert(sizeof(C) == 1, "logged trees hold byte keys");
+
+    static constexpr char kSnapshotMagic[8] = {'R', 'A', 'D', 'I', 'X', 'S', 'N', 'P'};
+    static constexpr size_t kFrameHeader = sizeof(uint32_t) + sizeof(uint64_t);
+
+    enum Op : uint8_t { kInsert = 1, kDelete = 2, kDeletePrefix = 3 };
+
+    std::string dir;
+    Options options;
+
+    std::mutex mutex;
+    std::condition_variable flushed;
+    Tree<K, T> master;
+    std::string pending;         // records not yet handed to a leader
+    uint64_t queued = 0;         // writes queued so far
+    uint64_t durable = 0;        // writes on disk
+    bool flushing = false;       // a leader is writing a frame
+    bool checkpointing = false;
+    bool failed = false;
+    int fd = -1;                 // current log
+    uint64_t gen = 0;            // generation of the current log
+    uint64_t logBytes = 0;       // size of the logs a checkpoint would delete
+    uint64_t syncs = 0;
+
+    DurableTree(std::string d, Options o) : dir(std::move(d)), options(o) {}
+
+    std::string path(const std::string& name) const {
+        return dir + "/" + name;
+    }
+
+    std::string logPath(uint64_t g) const {
+        return path("wal." + std::to_string(g));
+    }
+
+    // Generations of the logs in the directory, in ascending order
+    std::vector<uint64_t> logs() const {
+        std::vector<uint64_t> gens;
+        DIR* d = opendir(dir.c_str());
+        if (!d) {
+            return gens;
+        }
+        while (auto entry = readdir(d)) {
+            const char* name = entry->d_name;
+            if (std::strncmp(name, "wal.", 4) != 0 || !name[4]) {
+                continue;
+            }
+            char* end;
+            uint64_t g = std::strtoull(name + 4, &end, 10);
+            if (!*end) {
+                gens.push_back(g);
+            }
+        }
+        closedir(d);
+        std::sort(gens.begin(), gens.end());
+        return gens;
+    }
+
+    static bool syncFd(int f) {
+#ifdef __linux__
+        return fdatasync(f) == 0;
+#else
+        return fsync(f) == 0;
+#endif
+    }
+
+    // Syncs the directory, so files created or renamed in it survive
+    bool syncDir() const {
+        int d = ::open(dir.c_str(), O_RDONLY);
+        if (d < 0) {
+            return false;
+        }
+        bool ok = fsync(d) == 0;
+        close(d);
+        return ok;
+    }
+
+    static bool writeAll(int f, const char* p, size_t n) {
+        while (n > 0) {
+            ssize_t written = ::write(f, p, n);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            p += written;
+            n -= written;
+        }
+        return true;
+    }
+
+    bool startLog(uint64_t g) {
+        int f = ::open(logPath(g).c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+        if (f < 0) {
+            return false;
+        }
+        if (!syncDir()) {
+            close(f);
+            return false;
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+        fd = f;
+        gen = g;
+        return true;
+    }
+
+    static void appendKey(std::string& out, Op op, const K& k) {
+        out.push_back(static_cast<char>(op));
+        appendVarint(out, k.size());
+        out.append(reinterpret_cast<const char*>(k.data()), k.size());
+    }
+
+    static void appendInsert(std::string& out, const K& k, const T& v) {
+        appendKey(out, kInsert, k);
+        std::string value;
+        ValueCodec<T>::encode(v, value);
+        appendVarint(out, value.size());
+        out += value;
+    }
+
+    // Applies the records of one frame in a single transaction. Returns
+    // false if they do not decode.
+    static bool replay(Tree<K, T>& tree, const char* p, const char* end) {
+        auto txn = tree.txn();
+        while (p < end) {
+            auto op = static_cast<uint8_t>(*p++);
+            uint64_t keyLen;
+            if (!readVarint(p, end, keyLen) || keyLen > static_cast<uint64_t>(end - p)) {
+                return false;
+            }
+            KeyViewOf<K> key(reinterpret_cast<const C*>(p), keyLen);
+            p += keyLen;
+            if (op == kInsert) {
+                uint64_t valueLen;
+                T v{};
+                if (!readVarint(p, end, valueLen) || valueLen > static_cast<uint64_t>(end - p) ||
+                    !ValueCodec<T>::decode(p, valueLen, v)) {
+                    return false;
+                }
+                p += valueLen;
+                txn.insert(key, v);
+            } else if (op == kDelete) {
+                txn.del(key);
+            } else if (op == kDeletePrefix) {
+                txn.deletePrefix(key);
+            } else {
+                return false;
+            }
+        }
+        txn.commit();
+        return true;
+    }
+
+    // Replays the frames of the log for generation g up to the first one
+    // that is torn or fails its checksum
+    bool replayLog(uint64_t g) {
+        std::ifstream in(logPath(g), std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        logBytes += bytes.size();
+        const char* p = bytes.data();
+        const char* end = p + bytes.size();
+        while (static_cast<size_t>(end - p) >= kFrameHeader) {
+            uint32_t length;
+            uint64_t sum;
+            std::memcpy(&length, p, sizeof(length));
+            std::memcpy(&sum, p + sizeof(length), sizeof(sum));
+            if (length > static_cast<size_t>(end - p) - kFrameHeader) {
+                break;
+            }
+            Checksum check;
+            check.update(p + kFrameHeader, length);
+            if (check.value() != sum) {
+                break;
+            }
+            if (!replay(master, p + kFrameHeader, p + kFrameHeader + length)) {
+                return false;
+            }
+            p += kFrameHeader + length;
+        }
+        return true;
+    }
+
+    bool loadSnapshot(uint64_t& covered) {
+        std::ifstream in(path("snapshot"), std::ios::binary);
+        if (!in) {
+            covered = 0;
+            return true;
+        }
+        char magic[sizeof(kSnapshotMagic)];
+        if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, kSnapshotMagic, sizeof(magic)) != 0 ||
+            !in.read(reinterpret_cast<char*>(&covered), sizeof(covered))) {
+            return false;
+        }
+        auto tree = Tree<K, T>::deserialize(in);
+        if (!tree) {
+            return false;
+        }
+        master = std::move(*tree);
+        return true;
+    }
+
+    // Writes snapshot as covering the logs up to generation covered, then
+    // renames it into place
+    bool writeSnapshot(const Tree<K, T>& snapshot, uint64_t covered) const {
+        std::string tmp = path("snapshot.tmp");
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            out.write(kSnapshotMagic, sizeof(kSnapshotMagic));
+            out.write(reinterpret_cast<const char*>(&covered), sizeof(covered));
+            if (!snapshot.serialize(out) || !out.flush()) {
+                return false;
+            }
+        }
+        int f = ::open(tmp.c_str(), O_RDONLY);
+        if (f < 0) {
+            return false;
+        }
+        bool ok = fsync(f) == 0;
+        close(f);
+        return ok && std::rename(tmp.c_str(), path("snapshot").c_str()) == 0 && syncDir();
+    }
+
+    // Leads one group commit: writes every queued record as a frame and
+    // syncs it. The lock is released while the frame is written.
+    void flush(std::unique_lock<std::mutex>& lock) {
+        flushing = true;
+        std::string records;
+        records.swap(pending);
+        uint64_t upTo = queued;
+
+        lock.unlock();
+        char header[kFrameHeader];
+        auto length = static_cast<uint32_t>(records.size());
+        Checksum check;
+        check.update(records.data(), records.size());
+        uint64_t sum = check.value();
+        std::memcpy(header, &length, sizeof(length));
+        std::memcpy(header + sizeof(length), &sum, sizeof(sum));
+        bool ok = writeAll(fd, header, kFrameHeader) && writeAll(fd, records.data(), records.size()) &&
+                  (!options.sync || syncFd(fd));
+        lock.lock();
+
+        flushing = false;
+        syncs++;
+        if (ok) {
+            durable = upTo;
+            logBytes += kFrameHeader + records.size();
+        } else {
+            failed = true;
+        }
+        flushed.notify_all();
+    }
+
+    // Queues the records of a write the tree has already applied and waits
+    // until they are on disk, leading a group commit if no one else is
+    bool commit(std::unique_lock<std::mutex>& lock, const std::string& records) {
+        pending += records;
+        uint64_t seq = ++queued;
+        while (durable < seq && !failed) {
+            if (flushing) {
+                flushed.wait(lock);
+            } else {
+                flush(lock);
+            }
+        }
+        if (failed) {
+            return false;
+        }
+        // The write is durable whether or not the checkpoint succeeds; one
+        // that fails is tried again once the new log reaches the limit
+        if (options.checkpointBytes && logBytes >= options.checkpointBytes && !checkpointing) {
+            checkpoint(lock);
+        }
+        return true;
+    }
+
+    // Starts a new log and writes a snapshot covering the old ones. The
+    // caller holds the lock, which is released while the snapshot is
+    // written.
+    bool checkpoint(std::unique_lock<std::mutex>& lock) {
+        checkpointing = true;
+        while (flushing) {
+            flushed.wait(lock);
+        }
+        if (!pending.empty() && !failed) {
+            flush(lock);
+        }
+        uint64_t covered = gen;
+        if (failed || !startLog(gen + 1)) {
+            failed = true;
+            checkpointing = false;
+            flushed.notify_all();
+            return false;
+        }
+        logBytes = 0;
+        // The copy shares the tree's nodes; writes made while the snapshot
+        // is written copy the paths they change instead of touching it
+        auto snapshot = std::make_unique<Tree<K, T>>(master);
+
+        lock.unlock();
+        bool ok = writeSnapshot(*snapshot, covered);
+        if (ok) {
+            for (auto g : logs()) {
+                if (g <= covered) {
+                    std::remove(logPath(g).c_str());
+                }
+            }
+        }
+        lock.lock();
+
+        // Released under the lock, since it touches the tree's shared state
+        snapshot.reset();
+        checkpointing = false;
+        flushed.notify_all();
+        return ok;
+    }
+
+public:
+    DurableTree(const DurableTree&) = delete;
+    DurableTree& operator=(const DurableTree&) = delete;
+
+    ~DurableTree() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    // open recovers the tree kept in dir, creating the directory if it does
+    // not exist. Returns nothing if the directory cannot be used, the
+    // snapshot is unreadable or a logged record that passed its checksum
+    // does not decode.
+    static std::unique_ptr<DurableTree> open(const std::string& dir, Options options = Options()) {
+        std::unique_ptr<DurableTree> t(new DurableTree(dir, options));
+        if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+            return nullptr;
+        }
+        std::remove(t->path("snapshot.tmp").c_str());
+        uint64_t covered;
+        if (!t->loadSnapshot(covered)) {
+            return nullptr;
+        }
+        uint64_t last = covered;
+        for (auto g : t->logs()) {
+            if (g <= covered) {
+                continue;
+            }
+            if (!t->replayLog(g)) {
+                return nullptr;
+            }
+            last = g;
+        }
+        // A log with a torn tail is never appended to again
+        if (!t->startLog(last + 1)) {
+            return nullptr;
+        }
+        return t;
+    }
+
+    // insert, del and deletePrefix return once the write is on disk, or
+    // false if the log has failed
+    bool insert(const K& k, const T& v) {
+        std::string record;
+        appendInsert(record, k, v);
+        std::unique_lock<std::mutex> lock(mutex);
+        if (failed) {
+            return false;
+        }
+        master.insert(k, v);
+        return commit(lock, record);
+    }
+
+    bool del(const K& k) {
+        std::string record;
+        appendKey(record, kDelete, k);
+        std::unique_lock<std::mutex> lock(mutex);
+        if (failed) {
+            return false;
+        }
+        master.del(k);
+        return commit(lock, record);
+    }
+
+    bool deletePrefix(const K& k) {
+        std::string record;
+        appendKey(record, kDeletePrefix, k);
+        std::unique_lock<std::mutex> lock(mutex);
+        if (failed) {
+            return false;
+        }
+        master.deletePrefix(k);
+        return commit(lock, record);
+    }
+
+    // insertBatch logs and applies (key, value) pairs as one write, so they
+    // are recovered all together or not at all
+    template<typename Container>
+    bool insertBatch(const Container& entries) {
+        std::string records;
+        for (const auto& [k, v] : entries) {
+            appendInsert(records, k, v);
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        if (failed) {
+            return false;
+        }
+        master.insertBatch(entries);
+        return commit(lock, records);
+    }
+
+    // checkpoint writes a snapshot now and deletes the logs it covers
+    bool checkpoint() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (checkpointing) {
+            flushed.wait(lock);
+        }
+        return checkpoint(lock);
+    }
+
+    std::optional<T> Get(const K& search) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return master.Get(search);
+    }
+
+    int len() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return master.len();
+    }
+
+    // read calls fn with the tree under the lock, for reads that need more
+    // than one lookup to agree
+    template<typename F>
+    auto read(F&& fn) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return fn(static_cast<const Tree<K, T>&>(master));
+    }
+
+    // Group commits made so far, each one frame write and sync
+    uint64_t syncCount() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return syncs;
+    }
+
+    // False once a log write has failed
+    bool ok() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return !failed;
+    }
+};
+
+#endif // DURABLE_TREE_H
@@ -0,0 +1,629 @@
+//
+// Created by Ashesh Vidyut on 22/03/25.
+//
+
+#ifndef EDGE_TABLE_H
+#define EDGE_TABLE_H
+
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// EdgeTable maps a byte label to a child node and keeps its entries in
+// unsigned label order. Like the inner nodes of an Adaptive Radix Tree it
+// switches layout as the fan-out changes:
+//
+//   Node4   - up to 4 sorted labels, searched linearly
+//   Node16  - up to 16 sorted labels, searched with one SIMD compare
+//   Node48  - a 256-entry label index into 48 child slots
+//   Node256 - a direct 256-entry child array
+//
+// A node without children holds no table at all.
+template<typename N>
+class EdgeTable {
+public:
+    struct Entry {
+        uint8_t label;
+        N* node;
+    };
+
+private:
+    enum Kind : uint8_t { kEmpty, kNode4, kNode16, kNode48, kNode256 };
+
+    template<int Capacity>
+    struct Sorted {
+        uint8_t keys[Capacity];
+        N* children[Capacity];
+    };
+    using Node4 = Sorted<4>;
+    using Node16 = Sorted<16>;
+
+    // The wide layouts keep a bitmap of present labels so that ordered
+    // iteration skips empty labels a word at a time
+    struct Bitmap {
+        uint64_t words[4];
+
+        void set(uint8_t l) { words[l >> 6] |= uint64_t(1) << (l & 63); }
+        void reset(uint8_t l) { words[l >> 6] &= ~(uint64_t(1) << (l & 63)); }
+
+        // First present label >= from, or 256
+        int next(int from) const {
+            for (int w = from >> 6; w < 4; w++) {
+                uint64_t bits = words[w];
+                if (w == (from >> 6)) {
+                    bits &= ~uint64_t(0) << (from & 63);
+                }
+                if (bits) {
+                    return (w << 6) + __builtin_ctzll(bits);
+                }
+            }
+            return 256;
+        }
+
+        // Last present label < below, or -1
+        int prev(int below) const {
+            for (int w = (below - 1) >> 6; w >= 0; w--) {
+                uint64_t bits = words[w];
+                if (w == ((below - 1) >> 6) && (below & 63)) {
+                    bits &= ~(~uint64_t(0) << (below & 63));
+                }
+                if (bits) {
+                    return (w << 6) + 63 - __builtin_clzll(bits);
+                }
+            }
+            return -1;
+        }
+
+        // Last present label, or -1
+        int last() const {
+            for (int w = 3; w >= 0; w--) {
+                if (words[w]) {
+                    return (w << 6) + 63 - __builtin_clzll(words[w]);
+                }
+            }
+            return -1;
+        }
+    };
+
+    struct Node48 {
+        Bitmap present;
+        uint8_t index[256];  // slot + 1, or 0 when the label is absent
+        N* children[48];
+    };
+
+    struct Node256 {
+        Bitmap present;
+        N* children[256];
+    };
+
+    uint8_t kind;
+    uint16_t count;
+    void* body;
+
+    Node4* n4() const { return static_cast<Node4*>(body); }
+    Node16* n16() const { return static_cast<Node16*>(body); }
+    Node48* n48() const { return static_cast<Node48*>(body); }
+    Node256* n256() const { return static_cast<Node256*>(body); }
+
+    template<typename B>
+    static B* allocBody() {
+        B* b = new B;
+        std::memset(b, 0, sizeof(B));
+        return b;
+    }
+
+    void freeBody() {
+        switch (kind) {
+            case kNode4: delete n4(); break;
+            case kNode16: delete n16(); break;
+            case kNode48: delete n48(); break;
+            case kNode256: delete n256(); break;
+            default: break;
+        }
+        body = nullptr;
+    }
+
+    void copyFrom(const EdgeTable& other) {
+        kind = other.kind;
+        count = other.count;
+        body = nullptr;
+        switch (kind) {
+            case kNode4: body = new Node4(*other.n4()); break;
+            case kNode16: body = new Node16(*other.n16()); break;
+            case kNode48: body = new Node48(*other.n48()); break;
+            case kNode256: body = new Node256(*other.n256()); break;
+            default: break;
+        }
+    }
+
+    // Position of label in a sorted body, or -1
+    template<int Capacity>
+    int sortedFind(const Sorted<Capacity>* b, uint8_t label) const {
+        for (int i = 0; i < count; i++) {
+            if (b->keys[i] == label) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    int node16Find(uint8_t label) const {
+#if defined(__SSE2__)
+        __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(label)),
+                                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(n16()->keys)));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(cmp)) & ((1u << count) - 1);
+        return mask ? __builtin_ctz(mask) : -1;
+#elif defined(__ARM_NEON)
+        uint8x16_t cmp = vceqq_u8(vdupq_n_u8(label), vld1q_u8(n16()->keys));
+        // Narrow each byte of the compare result to a nibble of a 64-bit mask
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4)), 0);
+        if (count < 16) {
+            mask &= (uint64_t(1) << (count * 4)) - 1;
+        }
+        return mask ? __builtin_ctzll(mask) >> 2 : -1;
+#else
+        return sortedFind(n16(), label);
+#endif
+    }
+
+    // First position in a sorted body whose label is >= label
+    template<int Capacity>
+    int sortedLowerBound(const Sorted<Capacity>* b, uint8_t label) const {
+        int i = 0;
+        while (i < count && b->keys[i] < label) {
+            i++;
+        }
+        return i;
+    }
+
+    template<int Capacity>
+    void sortedInsert(Sorted<Capacity>* b, uint8_t label, N* node) {
+        int pos = sortedLowerBound(b, label);
+        std::memmove(b->keys + pos + 1, b->keys + pos, count - pos);
+        std::memmove(b->children + pos + 1, b->children + pos, (count - pos) * sizeof(N*));
+        b->keys[pos] = label;
+        b->children[pos] = node;
+        count++;
+    }
+
+    template<int Capacity>
+    void sortedErase(Sorted<Capacity>* b, int pos) {
+        std::memmove(b->keys + pos, b->keys + pos + 1, count - pos - 1);
+        std::memmove(b->children + pos, b->children + pos + 1, (count - pos - 1) * sizeof(N*));
+        count--;
+    }
+
+    template<int From, int To>
+    void moveSorted(Kind newKind) {
+        auto src = static_cast<Sorted<From>*>(body);
+        auto dst = allocBody<Sorted<To>>();
+        std::memcpy(dst->keys, src->keys, count);
+        std::memcpy(dst->children, src->children, count * sizeof(N*));
+        delete src;
+        body = dst;
+        kind = newKind;
+    }
+
+    void grow() {
+        switch (kind) {
+            case kEmpty:
+                body = allocBody<Node4>();
+                kind = kNode4;
+                break;
+            case kNode4:
+                moveSorted<4, 16>(kNode16);
+                break;
+            case kNode16: {
+                auto src = n16();
+                auto dst = allocBody<Node48>();
+                for (int i = 0; i < count; i++) {
+                    dst->index[src->keys[i]] = static_cast<uint8_t>(i + 1);
+                    dst->children[i] = src->children[i];
+                    dst->present.set(src->keys[i]);
+                }
+                delete src;
+                body = dst;
+                kind = kNode48;
+                break;
+            }
+            case kNode48: {
+                auto src = n48();
+                auto dst = allocBody<Node256>();
+                dst->present = src->present;
+                for (int l = src->present.next(0); l < 256; l = src->present.next(l + 1)) {
+                    dst->children[l] = src->children[src->index[l] - 1];
+                }
+                delete src;
+                body = dst;
+                kind = kNode256;
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    // Switches to a smaller layout once the fan-out drops well below the
+    // current one, leaving some slack so a node does not flip back and forth
+    void shrink() {
+        switch (kind) {
+            case kNode4:
+                if (count == 0) {
+                    freeBody();
+                    kind = kEmpty;
+                }
+                break;
+            case kNode16:
+                if (count <= 3) {
+                    moveSorted<16, 4>(kNode4);
+                }
+                break;
+            case kNode48:
+                if (count <= 12) {
+                    auto src = n48();
+                    auto dst = allocBody<Node16>();
+                    int i = 0;
+                    for (int l = src->present.next(0); l < 256; l = src->present.next(l + 1)) {
+                        dst->keys[i] = static_cast<uint8_t>(l);
+                        dst->children[i] = src->children[src->index[l] - 1];
+                        i++;
+                    }
+                    delete src;
+                    body = dst;
+                    kind = kNode16;
+                }
+                break;
+            case kNode256:
+                if (count <= 37) {
+                    auto src = n256();
+                    auto dst = allocBody<Node48>();
+                    int slot = 0;
+                    dst->present = src->present;
+                    for (int l = src->present.next(0); l < 256; l = src->present.next(l + 1)) {
+                        dst->index[l] = static_cast<uint8_t>(slot + 1);
+                        dst->children[slot++] = src->children[l];
+                    }
+                    delete src;
+                    body = dst;
+                    kind = kNode48;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+public:
+    // Forward iterator over the entries in label order. For the sorted
+    // layouts pos is a slot, for Node48/Node256 it is the label itself.
+    class const_iterator {
+    private:
+        const EdgeTable* table;
+        int pos;
+
+        friend class EdgeTable;
+
+        const_iterator(const EdgeTable* t, int p) : table(t), pos(p) {
+            skipEmpty();
+        }
+
+        void skipEmpty() {
+            if (pos >= 256) {
+                return;
+            }
+            if (table->kind == kNode48) {
+                pos = table->n48()->present.next(pos);
+            } else if (table->kind == kNode256) {
+                pos = table->n256()->present.next(pos);
+            }
+        }
+
+    public:
+        Entry operator*() const {
+            switch (table->kind) {
+                case kNode4: return {table->n4()->keys[pos], table->n4()->children[pos]};
+                case kNode16: return {table->n16()->keys[pos], table->n16()->children[pos]};
+                case kNode48: {
+                    auto b = table->n48();
+                    return {static_cast<uint8_t>(pos), b->children[b->index[pos] - 1]};
+                }
+                default: return {static_cast<uint8_t>(pos), table->n256()->children[pos]};
+            }
+        }
+
+        // Label of the entry, read without touching its child slot
+        uint8_t label() const {
+            return table->kind == kNode4 ? table->n4()->keys[pos]
+                 : table->kind == kNode16 ? table->n16()->keys[pos]
+                 : static_cast<uint8_t>(pos);
+        }
+
+        const_iterator& operator++() {
+            pos++;
+            skipEmpty();
+            return *this;
+        }
+
+        bool operator==(const const_iterator& other) const { return pos == other.pos; }
+        bool operator!=(const const_iterator& other) const { return pos != other.pos; }
+    };
+
+    EdgeTable() : kind(kEmpty), count(0), body(nullptr) {}
+
+    EdgeTable(const EdgeTable& other) {
+        copyFrom(other);
+    }
+
+    EdgeTable(EdgeTable&& other) noexcept : kind(other.kind), count(other.count), body(other.body) {
+        other.kind = kEmpty;
+        other.count = 0;
+        other.body = nullptr;
+    }
+
+    EdgeTable& operator=(const EdgeTable& other) {
+        if (this != &other) {
+            freeBody();
+            copyFrom(other);
+        }
+        return *this;
+    }
+
+    EdgeTable& operator=(EdgeTable&& other) noexcept {
+        if (this != &other) {
+            freeBody();
+            kind = other.kind;
+            count = other.count;
+            body = other.body;
+            other.kind = kEmpty;
+            other.count = 0;
+            other.body = nullptr;
+        }
+        return *this;
+    }
+
+    ~EdgeTable() {
+        freeBody();
+    }
+
+    void swap(EdgeTable& other) noexcept {
+        std::swap(kind, other.kind);
+        std::swap(count, other.count);
+        std::swap(body, other.body);
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    const_iterator begin() const {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const {
+        return const_iterator(this, (kind == kNode48 || kind == kNode256) ? 256 : count);
+    }
+
+    // Returns an iterator to the first entry whose label is >= label
+    const_iterator lowerBound(uint8_t label) const {
+        switch (kind) {
+            case kNode4: return const_iterator(this, sortedLowerBound(n4(), label));
+            case kNode16: return const_iterator(this, sortedLowerBound(n16(), label));
+            case kNode48:
+            case kNode256: return const_iterator(this, label);
+            default: return end();
+        }
+    }
+
+    // Returns the child for label, or nullptr
+    N* find(uint8_t label) const {
+        switch (kind) {
+            case kNode4: {
+                int i = sortedFind(n4(), label);
+                return i < 0 ? nullptr : n4()->children[i];
+            }
+            case kNode16: {
+                int i = node16Find(label);
+                return i < 0 ? nullptr : n16()->children[i];
+            }
+            case kNode48: {
+                uint8_t slot = n48()->index[label];
+                return slot ? n48()->children[slot - 1] : nullptr;
+            }
+            case kNode256:
+                return n256()->children[label];
+            default:
+                return nullptr;
+        }
+    }
+
+    // Returns the slot holding the child for label, or nullptr if the
+    // layout has no slot for it. Concurrent trees load and swap children
+    // through the slot atomically; a Node256 slot may hold nullptr.
+    N* const* slot(uint8_t label) const {
+        switch (kind) {
+            case kNode4: {
+                int i = sortedFind(n4(), label);
+                return i < 0 ? nullptr : &n4()->children[i];
+            }
+            case kNode16: {
+                int i = node16Find(label);
+                return i < 0 ? nullptr : &n16()->children[i];
+            }
+            case kNode48: {
+                uint8_t slot = n48()->index[label];
+                return slot ? &n48()->children[slot - 1] : nullptr;
+            }
+            case kNode256:
+                return &n256()->children[label];
+            default:
+                return nullptr;
+        }
+    }
+
+    // Prefetches the part of the table a lookup of label reads
+    void prefetch(uint8_t label) const {
+        switch (kind) {
+            case kNode4:
+            case kNode16: __builtin_prefetch(body); break;
+            case kNode48: __builtin_prefetch(&n48()->index[label]); break;
+            case kNode256: __builtin_prefetch(&n256()->children[label]); break;
+            default: break;
+        }
+    }
+
+    N* front() const {
+        return count ? (*begin()).node : nullptr;
+    }
+
+    N* back() const {
+        switch (kind) {
+            case kNode4: return n4()->children[count - 1];
+            case kNode16: return n16()->children[count - 1];
+            case kNode48: {
+                int l = n48()->present.last();
+                return l < 0 ? nullptr : n48()->children[n48()->index[l] - 1];
+            }
+            case kNode256: {
+                int l = n256()->present.last();
+                return l < 0 ? nullptr : n256()->children[l];
+            }
+            default:
+                return nullptr;
+        }
+    }
+
+    // Returns the child with the largest label below label, or nullptr
+    N* before(uint8_t label) const {
+        switch (kind) {
+            case kNode4: {
+                int i = sortedLowerBound(n4(), label);
+                return i > 0 ? n4()->children[i - 1] : nullptr;
+            }
+            case kNode16: {
+                int i = sortedLowerBound(n16(), label);
+                return i > 0 ? n16()->children[i - 1] : nullptr;
+            }
+            case kNode48: {
+                int l = n48()->present.prev(label);
+                return l < 0 ? nullptr : n48()->children[n48()->index[l] - 1];
+            }
+            case kNode256: {
+                int l = n256()->present.prev(label);
+                return l < 0 ? nullptr : n256()->children[l];
+            }
+            default:
+                return nullptr;
+        }
+    }
+
+    // Adds a child for a label that is not present yet
+    void insert(uint8_t label, N* node) {
+        if ((kind == kEmpty) || (kind == kNode4 && count == 4) ||
+            (kind == kNode16 && count == 16) || (kind == kNode48 && count == 48)) {
+            grow();
+        }
+        switch (kind) {
+            case kNode4: sortedInsert(n4(), label, node); break;
+            case kNode16: sortedInsert(n16(), label, node); break;
+            case kNode48: {
+                auto b = n48();
+                int slot = 0;
+                while (b->children[slot]) slot++;
+                b->children[slot] = node;
+                b->index[label] = static_cast<uint8_t>(slot + 1);
+                b->present.set(label);
+                count++;
+                break;
+            }
+            case kNode256:
+                n256()->children[label] = node;
+                n256()->present.set(label);
+                count++;
+                break;
+            default:
+                break;
+        }
+    }
+
+    // Points an existing label at a new child. Returns false if absent.
+    bool replace(uint8_t label, N* node) {
+        switch (kind) {
+            case kNode4: {
+                int i = sortedFind(n4(), label);
+                if (i < 0) return false;
+                n4()->children[i] = node;
+                return true;
+            }
+            case kNode16: {
+                int i = node16Find(label);
+                if (i < 0) return false;
+                n16()->children[i] = node;
+                return true;
+            }
+            case kNode48: {
+                uint8_t slot = n48()->index[label];
+                if (!slot) return false;
+                n48()->children[slot - 1] = node;
+                return true;
+            }
+            case kNode256:
+                if (!n256()->children[label]) return false;
+                n256()->children[label] = node;
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Removes the child for label. Returns false if absent.
+    bool erase(uint8_t label) {
+        switch (kind) {
+            case kNode4: {
+                int i = sortedFind(n4(), label);
+                if (i < 0) return false;
+                sortedErase(n4(), i);
+                break;
+            }
+            case kNode16: {
+                int i = node16Find(label);
+                if (i < 0) return false;
+                sortedErase(n16(), i);
+                break;
+            }
+            case kNode48: {
+                auto b = n48();
+                uint8_t slot = b->index[label];
+                if (!slot) return false;
+                b->children[slot - 1] = nullptr;
+                b->index[label] = 0;
+                b->present.reset(label);
+                count--;
+                break;
+            }
+            case kNode256:
+                if (!n256()->children[label]) return false;
+                n256()->children[label] = nullptr;
+                n256()->present.reset(label);
+                count--;
+                break;
+            default:
+                return false;
+        }
+        shrink();
+        return true;
+    }
+
+    void clear() {
+        freeBody();
+        kind = kEmpty;
+        count = 0;
+    }
+};
+
+#endif // EDGE_TABLE_H
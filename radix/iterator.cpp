@@ -6,6 +6,8 @@
 #define ITERATOR_H
 
 #include "node.hpp"
+#include <cstddef>
+#include <iterator>
 #include <vector>
 #include <memory>
 #include <regex.h>
@@ -23,28 +25,190 @@ struct IteratorResult {
     bool found;
 };
 
-// Forward declare Iterator
+// IteratorEntry is what dereferencing an Iterator or ReverseIterator gives:
+// the leaf's key as a view of the tree's key bytes and a reference to its
+// value. Nothing is copied, and both stay valid while the key is in the
+// tree.
 template<typename K, typename T>
-class Iterator;
+struct IteratorEntry {
+    KeyViewOf<K> key;
+    const T& val;
+};
+
+// Number of keys under the children of n whose labels are below label.
+// Children's counts are summed from whichever end of the edge table is
+// likely nearer and, from the top, subtracted from n's own count.
+template<typename K, typename T>
+int leavesBefore(const Node<K, T>* n, uint8_t label) {
+    int count = 0;
+    if (label < 128) {
+        for (auto it = n->edges.begin(), end = n->edges.lowerBound(label); it != end; ++it) {
+            count += (*it).node->leaves_in_subtree;
+        }
+        return count;
+    }
+    for (auto it = n->edges.lowerBound(label), end = n->edges.end(); it != end; ++it) {
+        count += (*it).node->leaves_in_subtree;
+    }
+    return n->leaves_in_subtree - (n->leaf ? 1 : 0) - count;
+}
+
+// seekBound finds where key falls among the keys under n. It returns the
+// first leaf whose key is not less than key, or greater than key if
+// pastEqual is set, and stores in before the number of keys under n ahead
+// of it; the leaf is nullptr if every key is ahead. The walk follows key's
+// path, counting the subtrees it passes on the left and remembering the
+// nearest subtree on the right, so it neither iterates nor reads the leaf
+// list.
+template<typename K, typename T>
+LeafNode<K, T>* seekBound(const Node<K, T>* n, KeyViewOf<K> key, bool pastEqual, int& before) {
+    LeafNode<K, T>* after = nullptr;  // first leaf right of the path so far
+    before = 0;
+    while (!key.empty()) {
+        // A key ending here is a proper prefix of the search key
+        if (n->leaf) {
+            before++;
+        }
+        auto label = static_cast<uint8_t>(key[0]);
+        before += leavesBefore(n, label);
+        if (label < 255) {
+            auto right = n->edges.lowerBound(label + 1);
+            if (right != n->edges.end()) {
+                after = (*right).node->minLeaf;
+            }
+        }
+        auto child = n->getEdge(key[0]);
+        if (!child) {
+            return after;
+        }
+        size_t common = child->prefix.commonPrefix(key);
+        if (common < child->prefix.size()) {
+            // key leaves the tree inside the child's prefix: the whole
+            // subtree is on one side of it
+            if (common < key.size() &&
+                static_cast<uint8_t>(child->prefix[common]) < static_cast<uint8_t>(key[common])) {
+                before += child->leaves_in_subtree;
+                return after;
+            }
+            return child->minLeaf;
+        }
+        key = key.substr(common);
+        n = child;
+    }
+    if (!pastEqual || !n->leaf) {
+        return n->minLeaf;
+    }
+    before++;
+    return n->edges.empty() ? after : (*n->edges.begin()).node->minLeaf;
+}
+
+// seekBoundFrom is seekBound for a node reached by a prefix seek, whose
+// keys all share their first depth elements. A key that leaves that path
+// falls before or after every key under the node.
+template<typename K, typename T>
+LeafNode<K, T>* seekBoundFrom(const Node<K, T>* n, size_t depth, KeyViewOf<K> key, bool pastEqual, int& before) {
+    before = 0;
+    if (depth == 0 || !n->minLeaf) {
+        return seekBound(n, key, pastEqual, before);
+    }
+    auto path = n->minLeaf->key;
+    size_t i = 0;
+    while (i < depth && i < key.size() && path[i] == key[i]) {
+        i++;
+    }
+    if (i == depth) {
+        return seekBound(n, key.substr(depth), pastEqual, before);
+    }
+    if (i == key.size() || static_cast<uint8_t>(key[i]) < static_cast<uint8_t>(path[i])) {
+        return n->minLeaf;
+    }
+    before = n->leaves_in_subtree;
+    return nullptr;
+}
+
+// leafAfter and leafBefore step from the leaf holding key, which must be
+// under n, to its neighbour in key order by walking key's path, so they
+// read only the nodes of n's own version and never the leaf list. Each
+// remembers the nearest subtree beside the path on the side it steps to.
+template<typename K, typename T>
+LeafNode<K, T>* leafAfter(const Node<K, T>* n, KeyViewOf<K> key) {
+    LeafNode<K, T>* after = nullptr;
+    while (!key.empty()) {
+        auto label = static_cast<uint8_t>(key[0]);
+        if (label < 255) {
+            auto right = n->edges.lowerBound(label + 1);
+            if (right != n->edges.end()) {
+                after = (*right).node->minLeaf;
+            }
+        }
+        auto child = n->getEdge(key[0]);
+        if (!child || child->prefix.size() > key.size()) {
+            return after;
+        }
+        key = key.substr(child->prefix.size());
+        n = child;
+    }
+    return n->edges.empty() ? after : n->edges.front()->minLeaf;
+}
 
-// Helper function to check if one sequence is a prefix of another
-template<typename K>
-bool hasPrefix(const K& str, const K& prefix) {
-    if (str.size() < prefix.size()) return false;
-    return std::equal(prefix.begin(), prefix.end(), str.begin());
+template<typename K, typename T>
+LeafNode<K, T>* leafBefore(const Node<K, T>* n, KeyViewOf<K> key) {
+    LeafNode<K, T>* before = nullptr;
+    while (!key.empty()) {
+        // A key ending here is a proper prefix of key; a subtree on the
+        // left lies between it and key
+        if (n->leaf) {
+            before = n->leaf;
+        }
+        if (auto below = n->edges.before(static_cast<uint8_t>(key[0]))) {
+            before = below->maxLeaf;
+        }
+        auto child = n->getEdge(key[0]);
+        if (!child || child->prefix.size() > key.size()) {
+            return before;
+        }
+        key = key.substr(child->prefix.size());
+        n = child;
+    }
+    return before;
 }
 
+// Forward declare Iterator
+template<typename K, typename T>
+class Iterator;
+
 // ReverseIterator class for traversing nodes in reverse in-order
 template<typename K, typename T>
 class ReverseIterator {
 private:
-    std::shared_ptr<Node<K, T>> node;
+    Node<K, T>* node;
     LeafNode<K, T>* iterLeafNode;
     int iterCounter;
-    K key;
+    size_t depth = 0;  // length of the path to node, once seekPrefix moved it
+    bool linked;       // the leaf list links this version's leaves
+
+    LeafNode<K, T>* following(const LeafNode<K, T>* leaf) const {
+        return linked ? leaf->nextLeaf : leafAfter(node, leaf->key.substr(depth));
+    }
+
+    LeafNode<K, T>* preceding(const LeafNode<K, T>* leaf) const {
+        return linked ? leaf->prevLeaf : leafBefore(node, leaf->key.substr(depth));
+    }
 
 public:
-    ReverseIterator(std::shared_ptr<Node<K, T>> n) : node(n) {
+    // A ReverseIterator is also a bidirectional iterator that moves from
+    // the largest key down. It ends when its keys run out, at end().
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = IteratorEntry<K, T>;
+    using difference_type = std::ptrdiff_t;
+    using reference = IteratorEntry<K, T>;
+    using pointer = void;
+
+    ReverseIterator() : ReverseIterator(nullptr) {}
+
+    // Steps along the leaf list if linked, which only the tree that owns
+    // the list may ask for, and otherwise through the nodes under n
+    ReverseIterator(Node<K, T>* n, bool linked = false) : node(n), linked(linked) {
         if (node) {
             iterLeafNode = node->maxLeaf;
             iterCounter = node->leaves_in_subtree;
@@ -54,17 +218,66 @@ public:
         }
     }
 
+    IteratorEntry<K, T> operator*() const {
+        return {iterLeafNode->key, iterLeafNode->val};
+    }
+
+    ReverseIterator& operator++() {
+        iterLeafNode = --iterCounter > 0 ? preceding(iterLeafNode) : nullptr;
+        return *this;
+    }
+
+    ReverseIterator operator++(int) {
+        auto before = *this;
+        ++*this;
+        return before;
+    }
+
+    // Steps back towards larger keys; from end() to the smallest key
+    ReverseIterator& operator--() {
+        iterLeafNode = iterLeafNode ? following(iterLeafNode) : node->minLeaf;
+        iterCounter++;
+        return *this;
+    }
+
+    ReverseIterator operator--(int) {
+        auto before = *this;
+        --*this;
+        return before;
+    }
+
+    bool operator==(const ReverseIterator& other) const {
+        return iterLeafNode == other.iterLeafNode;
+    }
+
+    bool operator!=(const ReverseIterator& other) const {
+        return iterLeafNode != other.iterLeafNode;
+    }
+
+    // The iterator as a range, from where it stands to the smallest key,
+    // so a seeked iterator works with range-for and STL algorithms
+    ReverseIterator begin() const {
+        return *this;
+    }
+
+    ReverseIterator end() const {
+        auto e = *this;
+        e.iterLeafNode = nullptr;
+        e.iterCounter = 0;
+        return e;
+    }
+
     // Seeks the iterator to a given prefix and returns the watch channel
-    void seekPrefixWatch(const K& prefix) {
-        key = prefix;
+    void seekPrefixWatch(KeyViewOf<K> search) {
+        size_t seeked = search.size();
         auto n = node;
-        K search = prefix;
         iterLeafNode = node->maxLeaf;
         iterCounter = node->leaves_in_subtree;
         
         while (n) {
             // Check for key exhaustion
             if (search.empty()) {
+                depth += seeked;
                 node = n;
                 iterLeafNode = node->maxLeaf;
                 iterCounter = node->leaves_in_subtree;
@@ -82,8 +295,9 @@ public:
 
             // Consume the search prefix
             if (hasPrefix(search, nextNode->prefix)) {
-                search = K(search.begin() + nextNode->prefix.size(), search.end());
+                search = search.substr(nextNode->prefix.size());
             } else if (hasPrefix(nextNode->prefix, search)) {
+                depth += seeked - search.size() + nextNode->prefix.size();
                 node = nextNode;
                 iterLeafNode = node->maxLeaf;
                 iterCounter = node->leaves_in_subtree;
@@ -104,97 +318,114 @@ public:
         seekPrefixWatch(prefix);
     }
 
+    // seekPrefix overload for any contiguous view of key elements
+    void seekPrefix(KeyViewOf<K> prefix) {
+        seekPrefixWatch(prefix);
+    }
+
+    // Seeks the iterator to the largest key less than or equal to key, so
+    // previous() returns it and then the keys before it
+    void seekReverseLowerBound(const K& key) {
+        seekReverseLowerBound(KeyViewOf<K>(key));
+    }
+
+    void seekReverseLowerBound(KeyViewOf<K> key) {
+        if (!node) {
+            return;
+        }
+        int before;
+        auto after = seekBoundFrom(node, depth, key, true, before);
+        iterCounter = before;
+        iterLeafNode = before == 0 ? nullptr : after ? preceding(after) : node->maxLeaf;
+    }
+
     // Returns the previous element in reverse order
     IteratorResult<K, T> previous() {
         IteratorResult<K, T> result;
         result.found = false;
 
-        if (iterCounter > 0 && iterLeafNode) {
-            iterCounter--;
-            
-            result.key = iterLeafNode->key;
-            result.val = iterLeafNode->val;
+        if (auto leaf = previousLeaf()) {
+            result.key = leaf->getKey();
+            result.val = leaf->val;
             result.found = true;
-            iterLeafNode = iterLeafNode->prevLeaf;
-            return result;
         }
-
         return result;
     }
+
+    // previousLeaf is previous() without the copies: it returns the leaf,
+    // whose key and val stay valid while the key is in the tree, or nullptr
+    // once the keys run out
+    const LeafNode<K, T>* previousLeaf() {
+        if (iterCounter <= 0 || !iterLeafNode) {
+            return nullptr;
+        }
+        auto leaf = iterLeafNode;
+        ++*this;
+        return leaf;
+    }
 };
 
-// PrefixIterator class for walking down the tree following a path
+// PrefixIterator walks down the tree along a path and returns the keys
+// that are prefixes of it, shortest first. It moves one node per call and
+// holds only that node and how far into the path it is, so it allocates
+// nothing and costs nothing for the nodes it is not asked to reach. A
+// borrowed path's elements must stay valid while it is in use; a path
+// handed over by value is kept by the iterator, and shared by its copies.
+// Every node it reaches lies on the exact path, so the keys need no
+// comparing with it.
 template<typename K, typename T>
 class PrefixIterator {
 private:
-    std::shared_ptr<Node<K, T>> rootNode;
-    K searchPath;
-    std::vector<std::shared_ptr<Node<K, T>>> nodeStack;
-    size_t stackIndex;
-    bool initialized;
+    const Node<K, T>* node;  // node whose leaf comes next, nullptr at the end
+    std::shared_ptr<const K> owned;  // the path, if it was handed over
+    KeyViewOf<K> path;
+    size_t offset;           // elements of path leading to node
+
+    // Moves to the child that continues the path, or to the end
+    void advance() {
+        if (offset == path.size()) {
+            node = nullptr;
+            return;
+        }
+        auto rest = path.substr(offset);
+        auto child = node->getEdge(rest[0]);
+        if (!child || !hasPrefix(rest, child->prefix)) {
+            node = nullptr;
+            return;
+        }
+        offset += child->prefix.size();
+        node = child;
+    }
 
 public:
-    PrefixIterator(std::shared_ptr<Node<K, T>> n, const K& path) 
-        : rootNode(n), searchPath(path), stackIndex(0), initialized(false) {}
+    PrefixIterator(const Node<K, T>* n, KeyViewOf<K> p) : node(n), path(p), offset(0) {}
+
+    PrefixIterator(const Node<K, T>* n, K&& p)
+        : node(n), owned(std::make_shared<const K>(std::move(p))), path(*owned), offset(0) {}
 
     // Returns the next node in order along the path
     IteratorResult<K, T> next() {
         IteratorResult<K, T> result;
         result.found = false;
 
-        // Initialize the path walk if not done yet
-        if (!initialized) {
-            initializePath();
-            initialized = true;
-        }
-
-        // Return the next leaf from the stack
-        while (stackIndex < nodeStack.size()) {
-            auto currentNode = nodeStack[stackIndex];
-            stackIndex++;
-            
-            if (currentNode->leaf) {
-                result.key = currentNode->leaf->key;
-                result.val = currentNode->leaf->val;
-                result.found = true;
-                return result;
-            }
+        if (auto leaf = nextLeaf()) {
+            result.key = leaf->getKey();
+            result.val = leaf->val;
+            result.found = true;
         }
-
         return result;
     }
 
-private:
-    void initializePath() {
-        if (!rootNode) return;
-
-        auto currentNode = rootNode;
-        K remainingPath = searchPath;
-
-        // Start with the root node
-        nodeStack.push_back(currentNode);
-
-        // Walk down the tree following the path
-        while (currentNode && !remainingPath.empty()) {
-            // Look for an edge that matches the next character
-            auto nextNode = currentNode->getEdge(remainingPath[0]);
-            
-            if (!nextNode) {
-                break;
-            }
-
-            // Check if the node's prefix matches the remaining path
-            if (hasPrefix(remainingPath, nextNode->prefix)) {
-                // Add this node to the stack
-                nodeStack.push_back(nextNode);
-                
-                // Consume the prefix
-                remainingPath = K(remainingPath.begin() + nextNode->prefix.size(), remainingPath.end());
-                currentNode = nextNode;
-            } else {
-                break;
+    // nextLeaf is next() without the copies, returning the leaf or nullptr
+    const LeafNode<K, T>* nextLeaf() {
+        while (node) {
+            auto n = node;
+            advance();
+            if (n->leaf) {
+                return n->leaf;
             }
         }
+        return nullptr;
     }
 };
 
@@ -202,14 +433,44 @@ private:
 template<typename K, typename T>
 class Iterator {
 private:
-    std::shared_ptr<Node<K, T>> node;
+    Node<K, T>* node;
     LeafNode<K, T>* iterLeafNode;
     int iterCounter;
-    K key;
-    bool seekLowerBoundFlag;
+    size_t depth = 0;  // length of the path to node, once seekPrefix moved it
+    bool linked;       // the leaf list links this version's leaves
+
+    LeafNode<K, T>* following(const LeafNode<K, T>* leaf) const {
+        return linked ? leaf->nextLeaf : leafAfter(node, leaf->key.substr(depth));
+    }
+
+    LeafNode<K, T>* preceding(const LeafNode<K, T>* leaf) const {
+        return linked ? leaf->prevLeaf : leafBefore(node, leaf->key.substr(depth));
+    }
+
+    void seekToBound(KeyViewOf<K> key, bool pastEqual) {
+        if (!node) {
+            return;
+        }
+        int before;
+        iterLeafNode = seekBoundFrom(node, depth, key, pastEqual, before);
+        iterCounter = node->leaves_in_subtree - before;
+    }
 
 public:
-    Iterator(std::shared_ptr<Node<K, T>> n) : node(n), seekLowerBoundFlag(false) {
+    // An Iterator is also a bidirectional iterator over its keys in order,
+    // ending at end() once they run out. Dereferencing gives an
+    // IteratorEntry, which refers to the leaf instead of copying it.
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = IteratorEntry<K, T>;
+    using difference_type = std::ptrdiff_t;
+    using reference = IteratorEntry<K, T>;
+    using pointer = void;
+
+    Iterator() : Iterator(nullptr) {}
+
+    // Steps along the leaf list if linked, which only the tree that owns
+    // the list may ask for, and otherwise through the nodes under n
+    Iterator(Node<K, T>* n, bool linked = false) : node(n), linked(linked) {
         if (node) {
             iterLeafNode = node->minLeaf;
             iterCounter = node->leaves_in_subtree;
@@ -219,36 +480,66 @@ public:
         }
     }
 
-    // Range-based for loop operators
-    std::pair<const K&, const T&> operator*() const {
+    IteratorEntry<K, T> operator*() const {
         return {iterLeafNode->key, iterLeafNode->val};
     }
 
     Iterator& operator++() {
-        if (iterCounter > 0 && iterLeafNode) {
-            iterCounter--;
-            iterLeafNode = iterLeafNode->nextLeaf;
-        }
+        iterLeafNode = --iterCounter > 0 ? following(iterLeafNode) : nullptr;
         return *this;
     }
 
+    Iterator operator++(int) {
+        auto before = *this;
+        ++*this;
+        return before;
+    }
+
+    // Steps back; from end() to the largest key
+    Iterator& operator--() {
+        iterLeafNode = iterLeafNode ? preceding(iterLeafNode) : node->maxLeaf;
+        iterCounter++;
+        return *this;
+    }
+
+    Iterator operator--(int) {
+        auto before = *this;
+        --*this;
+        return before;
+    }
+
+    bool operator==(const Iterator& other) const {
+        return iterLeafNode == other.iterLeafNode;
+    }
+
     bool operator!=(const Iterator& other) const {
         return iterLeafNode != other.iterLeafNode;
     }
 
+    // The iterator as a range, from where it stands to its last key, so a
+    // seeked iterator works with range-for and STL algorithms
+    Iterator begin() const {
+        return *this;
+    }
+
+    Iterator end() const {
+        auto e = *this;
+        e.iterLeafNode = nullptr;
+        e.iterCounter = 0;
+        return e;
+    }
+
     // Seeks the iterator to a given prefix and returns the watch channel
-    void seekPrefixWatch(const K& prefix) {
-        // Wipe the stack
-        seekLowerBoundFlag = false;
-        key = prefix;
+    void seekPrefixWatch(KeyViewOf<K> search) {
+        size_t seeked = search.size();
         auto n = node;
-        K search = prefix;
         iterLeafNode = node->minLeaf;
         iterCounter = node->leaves_in_subtree;
         
         while (n) {
             // Check for key exhaustion
             if (search.empty()) {
+                depth += seeked;
                 node = n;
                 iterLeafNode = node->minLeaf;
                 iterCounter = node->leaves_in_subtree;
@@ -266,8 +557,9 @@ public:
 
             // Consume the search prefix
             if (hasPrefix(search, nextNode->prefix)) {
-                search = K(search.begin() + nextNode->prefix.size(), search.end());
+                search = search.substr(nextNode->prefix.size());
             } else if (hasPrefix(nextNode->prefix, search)) {
+                depth += seeked - search.size() + nextNode->prefix.size();
                 node = nextNode;
                 iterLeafNode = node->minLeaf;
                 iterCounter = node->leaves_in_subtree;
@@ -288,10 +580,29 @@ public:
         seekPrefixWatch(prefix);
     }
 
-    // Seeks the iterator to a given key
+    // seekPrefix overload for any contiguous view of key elements
+    void seekPrefix(KeyViewOf<K> prefix) {
+        seekPrefixWatch(prefix);
+    }
+
+    // Seeks the iterator to the smallest key greater than or equal to key,
+    // so next() returns it and then the keys after it. After a seekPrefix
+    // the iterator stays within the prefix.
     void seekLowerBound(const K& key) {
-        seekLowerBoundFlag = true;
-        seekPrefixWatch(key);
+        seekLowerBound(KeyViewOf<K>(key));
+    }
+
+    void seekLowerBound(KeyViewOf<K> key) {
+        seekToBound(key, false);
+    }
+
+    // Seeks the iterator to the smallest key greater than key
+    void seekUpperBound(const K& key) {
+        seekUpperBound(KeyViewOf<K>(key));
+    }
+
+    void seekUpperBound(KeyViewOf<K> key) {
+        seekToBound(key, true);
     }
 
     // Returns the next element in order
@@ -299,33 +610,115 @@ public:
         IteratorResult<K, T> result;
         result.found = false;
 
-        if (iterCounter > 0 && iterLeafNode) {
-            iterCounter--;
-            
-            result.key = iterLeafNode->key;
-            result.val = iterLeafNode->val;
+        if (auto leaf = nextLeaf()) {
+            result.key = leaf->getKey();
+            result.val = leaf->val;
             result.found = true;
-            iterLeafNode = iterLeafNode->nextLeaf;
-            return result;
         }
-
         return result;
     }
+
+    // nextLeaf is next() without the copies: it returns the leaf, whose key
+    // and val stay valid while the key is in the tree, or nullptr once the
+    // keys run out
+    const LeafNode<K, T>* nextLeaf() {
+        if (iterCounter <= 0 || !iterLeafNode) {
+            return nullptr;
+        }
+        auto leaf = iterLeafNode;
+        ++*this;
+        return leaf;
+    }
+};
+
+// NodeIterator walks a subtree in key order by descending through its nodes
+// instead of following the leaf list, so it reads nothing outside the
+// version it started from. Readers of a ConcurrentTree snapshot use it, as
+// the writer relinks the leaf list while they read.
+template<typename K, typename T>
+class NodeIterator {
+private:
+    using EdgeIterator = typename EdgeTable<Node<K, T>>::const_iterator;
+
+    const Node<K, T>* pending;  // node whose leaf and children come next
+    std::vector<std::pair<EdgeIterator, EdgeIterator>> stack;
+
+public:
+    NodeIterator(const Node<K, T>* n) : pending(n) {}
+
+    // Seeks the iterator to the subtree of keys starting with prefix
+    void seekPrefix(KeyViewOf<K> search) {
+        stack.clear();
+        auto n = pending;
+        pending = nullptr;
+        while (n && !search.empty()) {
+            auto nextNode = n->getEdge(search[0]);
+            if (!nextNode) {
+                return;
+            }
+            if (hasPrefix(search, nextNode->prefix)) {
+                search = search.substr(nextNode->prefix.size());
+            } else if (hasPrefix(nextNode->prefix, search)) {
+                search = KeyViewOf<K>();
+            } else {
+                return;
+            }
+            n = nextNode;
+        }
+        pending = n;
+    }
+
+    void seekPrefix(const K& prefix) {
+        seekPrefix(KeyViewOf<K>(prefix));
+    }
+
+    // Returns the next element in order
+    IteratorResult<K, T> next() {
+        IteratorResult<K, T> result;
+        result.found = false;
+
+        while (true) {
+            if (pending) {
+                auto n = pending;
+                pending = nullptr;
+                if (!n->edges.empty()) {
+                    stack.push_back({n->edges.begin(), n->edges.end()});
+                }
+                if (n->leaf) {
+                    result.key = n->leaf->getKey();
+                    result.val = n->leaf->val;
+                    result.found = true;
+                    return result;
+                }
+                continue;
+            }
+            if (stack.empty()) {
+                return result;
+            }
+            auto& top = stack.back();
+            if (top.first == top.second) {
+                stack.pop_back();
+                continue;
+            }
+            pending = (*top.first).node;
+            ++top.first;
+        }
+    }
 };
 
 // Helper functions to create iterators
 template<typename K, typename T>
-Iterator<K, T> createIterator(std::shared_ptr<Node<K, T>> node) {
+Iterator<K, T> createIterator(Node<K, T>* node) {
     return Iterator<K, T>(node);
 }
 
 template<typename K, typename T>
-ReverseIterator<K, T> createReverseIterator(std::shared_ptr<Node<K, T>> node) {
+ReverseIterator<K, T> createReverseIterator(Node<K, T>* node) {
     return ReverseIterator<K, T>(node);
 }
 
 template<typename K, typename T>
-PrefixIterator<K, T> createPrefixIterator(std::shared_ptr<Node<K, T>> node, const K& path) {
+PrefixIterator<K, T> createPrefixIterator(Node<K, T>* node, KeyViewOf<K> path) {
     return PrefixIterator<K, T>(node, path);
 }
 
@@ -0,0 +1,472 @@
+//
+// Created by Ashesh Vidyut on 22/03/25.
+//
+
+#ifndef MAPPED_TREE_H
+#define MAPPED_TREE_H
+
+#include "tree.hpp"
+#include "value_codec.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Layout of a mapped tree image. Records hold offsets from the start of
+// the image instead of pointers, so the image can be mapped anywhere.
+// Integers are in host byte order and every record starts on an 8-byte
+// boundary:
+//
+//   MappedHeader
+//   uint64_t leafOffsets[keyCount]   offset of each leaf record, in key order
+//   node records, in pre-order, root first
+//   leaf records, in key order
+//
+// A node record is a MappedNode followed by the offsets of its children,
+// their labels in ascending order, and the node's prefix. The leaves under
+// a node are the consecutive run [firstLeaf, firstLeaf + leaves) of the
+// offset table, so a node needs no pointer to its own leaf, and GetAtIndex
+// is one table read. A leaf record is a MappedLeaf followed by the key and
+// the value's bytes.
+struct MappedHeader {
+    char magic[8];
+    uint32_t formatVersion;
+    uint32_t charSize;
+    uint64_t keyCount;
+    uint64_t rootOffset;
+    uint64_t imageSize;
+
+    static constexpr char kMagic[8] = {'R', 'A', 'D', 'I', 'X', 'M', 'A', 'P'};
+    static constexpr uint32_t kFormatVersion = 1;
+};
+
+struct MappedNode {
+    uint32_t firstLeaf;  // index of the first leaf under the node
+    uint32_t leaves;     // leaves under the node, its own included
+    uint32_t prefixLen;
+    uint16_t edgeCount;
+    uint8_t hasLeaf;     // the node's own key is leaf firstLeaf
+    uint8_t reserved;
+};
+
+struct MappedLeaf {
+    uint32_t keyLen;
+    uint32_t valLen;
+};
+
+static_assert(sizeof(MappedHeader) == 40 && sizeof(MappedNode) == 16 && sizeof(MappedLeaf) == 8,
+              "mapped records must keep their on-disk size");
+
+// Result of iterating a MappedTree. The key points into the mapped image
+// and stays valid as long as the tree.
+template<typename K, typename T>
+struct MappedResult {
+    KeyViewOf<K> key;
+    T val;
+    bool found;
+};
+
+// MappedTree is a read-only tree served straight from a file mapped into
+// memory. write() lays a Tree out as a pointer-free image; open() maps it
+// and reads it in place, so loading costs one mmap and the page faults of
+// whatever is then read, and processes that map the same file share one
+// copy of it through the page cache. Images are trusted: open() checks the
+// header but not every offset.
+template<typename K, typename T>
+class MappedTree {
+private:
+    using C = typename K::value_type;
+
+    const char* base = nullptr;
+    size_t length = 0;
+    bool owned = false;  // base was mapped by open() and is unmapped with the tree
+
+    MappedTree(const char* b, size_t n, bool own) : base(b), length(n), owned(own) {}
+
+    static size_t padded(size_t n) {
+        return (n + 7) & ~size_t(7);
+    }
+
+    const MappedHeader* header() const {
+        return reinterpret_cast<const MappedHeader*>(base);
+    }
+
+    const uint64_t* leafOffsets() const {
+        return reinterpret_cast<const uint64_t*>(base + sizeof(MappedHeader));
+    }
+
+    const MappedNode* nodeAt(uint64_t offset) const {
+        return reinterpret_cast<const MappedNode*>(base + offset);
+    }
+
+    const MappedNode* root() const {
+        return nodeAt(header()->rootOffset);
+    }
+
+    static const uint64_t* children(const MappedNode* n) {
+        return reinterpret_cast<const uint64_t*>(n + 1);
+    }
+
+    static const uint8_t* labels(const MappedNode* n) {
+        return reinterpret_cast<const uint8_t*>(children(n) + n->edgeCount);
+    }
+
+    static KeyViewOf<K> prefix(const MappedNode* n) {
+        return KeyViewOf<K>(reinterpret_cast<const C*>(labels(n) + n->edgeCount), n->prefixLen);
+    }
+
+    // Child of n on label, or nullptr
+    const MappedNode* edge(const MappedNode* n, uint8_t label) const {
+        auto first = labels(n);
+        auto last = first + n->edgeCount;
+        auto it = std::lower_bound(first, last, label);
+        if (it == last || *it != label) {
+            return nullptr;
+        }
+        return nodeAt(children(n)[it - first]);
+    }
+
+    const MappedLeaf* leafAt(uint64_t index) const {
+        return reinterpret_cast<const MappedLeaf*>(base + leafOffsets()[index]);
+    }
+
+    static KeyViewOf<K> leafKey(const MappedLeaf* leaf) {
+        return KeyViewOf<K>(reinterpret_cast<const C*>(leaf + 1), leaf->keyLen);
+    }
+
+    static T leafValue(const MappedLeaf* leaf) {
+        T v{};
+        ValueCodec<T>::decode(reinterpret_cast<const char*>(leaf + 1) + leaf->keyLen * sizeof(C), leaf->valLen, v);
+        return v;
+    }
+
+    static K toKey(KeyViewOf<K> key) {
+        return K(key.begin(), key.end());
+    }
+
+    bool valid() const {
+        if (length < sizeof(MappedHeader)) {
+            return false;
+        }
+        auto h = header();
+        return std::memcmp(h->magic, MappedHeader::kMagic, sizeof(h->magic)) == 0 &&
+               h->formatVersion == MappedHeader::kFormatVersion && h->charSize == sizeof(C) &&
+               h->imageSize == length && h->keyCount <= (length - sizeof(MappedHeader)) / sizeof(uint64_t) &&
+               h->rootOffset + sizeof(MappedNode) <= length;
+    }
+
+    void unmap() {
+        if (owned && base) {
+            munmap(const_cast<char*>(base), length);
+        }
+        base = nullptr;
+        length = 0;
+        owned = false;
+    }
+
+public:
+    MappedTree(const MappedTree&) = delete;
+    MappedTree& operator=(const MappedTree&) = delete;
+
+    MappedTree(MappedTree&& other) noexcept : base(other.base), length(other.length), owned(other.owned) {
+        other.base = nullptr;
+        other.owned = false;
+    }
+
+    MappedTree& operator=(MappedTree&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            std::swap(base, other.base);
+            std::swap(length, other.length);
+            std::swap(owned, other.owned);
+        }
+        return *this;
+    }
+
+    ~MappedTree() {
+        unmap();
+    }
+
+    // image lays tree out in the mapped format. Nodes are written in
+    // pre-order, each with placeholder child offsets that are filled in
+    // when the child is written; leaves follow, in key order.
+    static std::string image(const Tree<K, T>& tree) {
+        static_assert(sizeof(C) == 1, "mapped trees hold byte keys");
+        std::string out(sizeof(MappedHeader) + tree.len() * sizeof(uint64_t), '\0');
+        std::vector<const LeafNode<K, T>*> leaves;
+        leaves.reserve(tree.len());
+
+        struct Pending {
+            const Node<K, T>* node;
+            size_t slot;  // where the parent keeps this node's offset, 0 for the root
+        };
+        std::vector<Pending> stack{{tree.getRoot(), 0}};
+        std::vector<std::pair<uint8_t, const Node<K, T>*>> edges;
+        uint64_t rootOffset = out.size();
+        while (!stack.empty()) {
+            auto [n, slot] = stack.back();
+            stack.pop_back();
+            edges.clear();
+            for (const auto& e : n->edges) {
+                edges.push_back({static_cast<uint8_t>(e.label), e.node});
+            }
+
+            uint64_t at = out.size();
+            if (slot) {
+                std::memcpy(&out[slot], &at, sizeof(at));
+            }
+            KeyViewOf<K> p(n->prefix);
+            MappedNode rec{};
+            rec.firstLeaf = static_cast<uint32_t>(leaves.size());
+            rec.leaves = static_cast<uint32_t>(n->leaves_in_subtree);
+            rec.prefixLen = static_cast<uint32_t>(p.size());
+            rec.edgeCount = static_cast<uint16_t>(edges.size());
+            rec.hasLeaf = n->leaf ? 1 : 0;
+            out.append(reinterpret_cast<const char*>(&rec), sizeof(rec));
+            size_t childSlots = out.size();
+            out.append(edges.size() * sizeof(uint64_t), '\0');
+            for (const auto& e : edges) {
+                out.push_back(static_cast<char>(e.first));
+            }
+            out.append(reinterpret_cast<const char*>(p.data()), p.size() * sizeof(C));
+            out.resize(padded(out.size()), '\0');
+
+            if (n->leaf) {
+                leaves.push_back(n->leaf);
+            }
+            // Children are popped in label order, so leaves come out sorted
+            for (size_t i = edges.size(); i-- > 0;) {
+                stack.push_back({edges[i].second, childSlots + i * sizeof(uint64_t)});
+            }
+        }
+
+        for (size_t i = 0; i < leaves.size(); i++) {
+            uint64_t at = out.size();
+            std::memcpy(&out[sizeof(MappedHeader) + i * sizeof(uint64_t)], &at, sizeof(at));
+            KeyViewOf<K> key = leaves[i]->key;
+            MappedLeaf rec{static_cast<uint32_t>(key.size()), 0};
+            out.append(reinterpret_cast<const char*>(&rec), sizeof(rec));
+            out.append(reinterpret_cast<const char*>(key.data()), key.size() * sizeof(C));
+            size_t valStart = out.size();
+            ValueCodec<T>::encode(leaves[i]->val, out);
+            rec.valLen = static_cast<uint32_t>(out.size() - valStart);
+            std::memcpy(&out[at], &rec, sizeof(rec));
+            out.resize(padded(out.size()), '\0');
+        }
+
+        MappedHeader h{};
+        std::memcpy(h.magic, MappedHeader::kMagic, sizeof(h.magic));
+        h.formatVersion = MappedHeader::kFormatVersion;
+        h.charSize = sizeof(C);
+        h.keyCount = leaves.size();
+        h.rootOffset = rootOffset;
+        h.imageSize = out.size();
+        std::memcpy(&out[0], &h, sizeof(h));
+        return out;
+    }
+
+    // Writes tree's image to path. The image goes to a temporary file that
+    // is renamed over path, so processes still mapping an older image keep
+    // reading it. Returns false if the file could not be written.
+    static bool write(const Tree<K, T>& tree, const std::string& path) {
+        auto bytes = image(tree);
+        std::string tmp = path + ".tmp";
+        FILE* f = std::fopen(tmp.c_str(), "wb");
+        if (!f) {
+            return false;
+        }
+        bool ok = std::fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+        ok = std::fclose(f) == 0 && ok;
+        if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+            std::remove(tmp.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // Maps the image at path read-only. Returns nothing if the file cannot
+    // be mapped or does not hold an image for this key type.
+    static std::optional<MappedTree> open(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return std::nullopt;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(MappedHeader))) {
+            ::close(fd);
+            return std::nullopt;
+        }
+        void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            return std::nullopt;
+        }
+        MappedTree tree(static_cast<const char*>(p), st.st_size, true);
+        if (!tree.valid()) {
+            return std::nullopt;
+        }
+        return tree;
+    }
+
+    // Reads an image already in memory, e.g. shared memory or a buffer from
+    // image(). The bytes must be 8-byte aligned and outlive the tree.
+    static std::optional<MappedTree> view(const char* data, size_t size) {
+        MappedTree tree(data, size, false);
+        if (!tree.valid()) {
+            return std::nullopt;
+        }
+        return tree;
+    }
+
+    int len() const {
+        return static_cast<int>(header()->keyCount);
+    }
+
+    std::optional<T> Get(KeyViewOf<K> search) const {
+        const MappedNode* n = root();
+        while (!search.empty()) {
+            n = edge(n, static_cast<uint8_t>(search[0]));
+            if (!n) {
+                return std::nullopt;
+            }
+            KeyViewOf<K> p = prefix(n);
+            if (!hasPrefix(search, p)) {
+                return std::nullopt;
+            }
+            search = search.substr(p.size());
+        }
+        if (!n->hasLeaf) {
+            return std::nullopt;
+        }
+        return leafValue(leafAt(n->firstLeaf));
+    }
+
+    std::optional<T> Get(const K& search) const {
+        return Get(KeyViewOf<K>(search));
+    }
+
+    LongestPrefixResult<K, T> LongestPrefix(KeyViewOf<K> search) const {
+        const MappedNode* n = root();
+        const MappedNode* last = n->hasLeaf ? n : nullptr;
+        while (!search.empty()) {
+            n = edge(n, static_cast<uint8_t>(search[0]));
+            if (!n) {
+                break;
+            }
+            KeyViewOf<K> p = prefix(n);
+            if (!hasPrefix(search, p)) {
+                break;
+            }
+            search = search.substr(p.size());
+            if (n->hasLeaf) {
+                last = n;
+            }
+        }
+        if (!last) {
+            return {K{}, T{}, false};
+        }
+        auto leaf = leafAt(last->firstLeaf);
+        return {toKey(leafKey(leaf)), leafValue(leaf), true};
+    }
+
+    LongestPrefixResult<K, T> LongestPrefix(const K& search) const {
+        return LongestPrefix(KeyViewOf<K>(search));
+    }
+
+    // Keys that are prefixes of search, shortest first
+    std::vector<std::pair<K, T>> findMatchingPrefixes(KeyViewOf<K> search) const {
+        std::vector<std::pair<K, T>> results;
+        if (search.empty()) {
+            return results;
+        }
+        const MappedNode* n = root();
+        while (n) {
+            if (n->hasLeaf) {
+                auto leaf = leafAt(n->firstLeaf);
+                results.push_back({toKey(leafKey(leaf)), leafValue(leaf)});
+            }
+            if (search.empty()) {
+                break;
+            }
+            n = edge(n, static_cast<uint8_t>(search[0]));
+            if (!n || !hasPrefix(search, prefix(n))) {
+                break;
+            }
+            search = search.substr(n->prefixLen);
+        }
+        return results;
+    }
+
+    std::vector<std::pair<K, T>> findMatchingPrefixes(const K& search) const {
+        return findMatchingPrefixes(KeyViewOf<K>(search));
+    }
+
+    std::tuple<K, T, bool> GetAtIndex(int index) const {
+        if (index < 0 || index >= len()) {
+            return {K{}, T{}, false};
+        }
+        auto leaf = leafAt(index);
+        return {toKey(leafKey(leaf)), leafValue(leaf), true};
+    }
+
+    // MappedIterator walks a run of the leaf offset table: every key, or
+    // after seekPrefix the keys under the node the prefix leads to
+    class MappedIterator {
+    private:
+        const MappedTree* tree;
+        uint64_t pos;
+        uint64_t end;
+
+        friend class MappedTree;
+
+        MappedIterator(const MappedTree* t, uint64_t p, uint64_t e) : tree(t), pos(p), end(e) {}
+
+    public:
+        void seekPrefix(KeyViewOf<K> search) {
+            const MappedNode* n = tree->root();
+            while (!search.empty()) {
+                n = tree->edge(n, static_cast<uint8_t>(search[0]));
+                if (!n) {
+                    pos = end = 0;
+                    return;
+                }
+                KeyViewOf<K> p = prefix(n);
+                if (hasPrefix(search, p)) {
+                    search = search.substr(p.size());
+                } else if (hasPrefix(p, search)) {
+                    break;
+                } else {
+                    pos = end = 0;
+                    return;
+                }
+            }
+            pos = n->firstLeaf;
+            end = pos + n->leaves;
+        }
+
+        void seekPrefix(const K& search) {
+            seekPrefix(KeyViewOf<K>(search));
+        }
+
+        MappedResult<K, T> next() {
+            if (pos >= end) {
+                return {KeyViewOf<K>(), T{}, false};
+            }
+            auto leaf = tree->leafAt(pos++);
+            return {leafKey(leaf), leafValue(leaf), true};
+        }
+    };
+
+    MappedIterator iterator() const {
+        return MappedIterator(this, 0, header()->keyCount);
+    }
+};
+
+#endif // MAPPED_TREE_H
@@ -4,8 +4,15 @@
 
 #include "node.hpp"
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 // This file is intentionally left mostly empty as the implementation is now in the header file.
 // The template-based implementation is defined in node.hpp.
 
@@ -17,28 +24,137 @@ void initializeNode() {
     // Any global initialization code for nodes
 }
 
-// Helper function implementations
-template<typename K>
-bool hasPrefix(const K& str, const K& prefix) {
-    if (prefix.size() > str.size()) {
-        return false;
+// Byte comparison kernels
+size_t mismatchBytesScalar(const void* a, const void* b, size_t n) {
+    auto pa = static_cast<const unsigned char*>(a);
+    auto pb = static_cast<const unsigned char*>(b);
+    size_t i = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    for (; i + 8 <= n; i += 8) {
+        uint64_t x, y;
+        std::memcpy(&x, pa + i, 8);
+        std::memcpy(&y, pb + i, 8);
+        if (x != y) {
+            return i + (__builtin_ctzll(x ^ y) >> 3);
+        }
+    }
+#endif
+    while (i < n && pa[i] == pb[i]) {
+        i++;
     }
-    return std::equal(prefix.begin(), prefix.end(), str.begin());
+    return i;
 }
 
-template<typename K>
-int longestPrefix(const K& k1, const K& k2) {
-    auto it1 = k1.begin();
-    auto it2 = k2.begin();
-    int count = 0;
-    
-    while (it1 != k1.end() && it2 != k2.end() && *it1 == *it2) {
-        ++it1;
-        ++it2;
-        ++count;
+#if defined(__x86_64__) || defined(__i386__)
+size_t mismatchBytesSSE2(const void* a, const void* b, size_t n) {
+    auto pa = static_cast<const unsigned char*>(a);
+    auto pb = static_cast<const unsigned char*>(b);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pa + i));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pb + i));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)));
+        if (mask != 0xFFFF) {
+            return i + __builtin_ctz(~mask);
+        }
     }
-    
-    return count;
+    return i + mismatchBytesScalar(pa + i, pb + i, n - i);
+}
+
+__attribute__((target("avx2")))
+size_t mismatchBytesAVX2(const void* a, const void* b, size_t n) {
+    auto pa = static_cast<const unsigned char*>(a);
+    auto pb = static_cast<const unsigned char*>(b);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pa + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pb + i));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+        if (mask != 0xFFFFFFFFu) {
+            return i + __builtin_ctz(~mask);
+        }
+    }
+    return i + mismatchBytesSSE2(pa + i, pb + i, n - i);
+}
+#else
+size_t mismatchBytesSSE2(const void* a, const void* b, size_t n) {
+    return mismatchBytesScalar(a, b, n);
+}
+
+size_t mismatchBytesAVX2(const void* a, const void* b, size_t n) {
+    return mismatchBytesScalar(a, b, n);
+}
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+size_t mismatchBytesNEON(const void* a, const void* b, size_t n) {
+    auto pa = static_cast<const unsigned char*>(a);
+    auto pb = static_cast<const unsigned char*>(b);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t eq = vceqq_u8(vld1q_u8(pa + i), vld1q_u8(pb + i));
+        if (vminvq_u8(eq) != 0xFF) {
+            // One nibble per byte, set where the bytes are equal
+            uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+            return i + (__builtin_ctzll(~mask) >> 2);
+        }
+    }
+    return i + mismatchBytesScalar(pa + i, pb + i, n - i);
+}
+#else
+size_t mismatchBytesNEON(const void* a, const void* b, size_t n) {
+    return mismatchBytesScalar(a, b, n);
+}
+#endif
+
+using MismatchFn = size_t (*)(const void*, const void*, size_t);
+
+static MismatchFn selectMismatchKernel(const char** name) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx2")) {
+        *name = "avx2";
+        return mismatchBytesAVX2;
+    }
+    *name = "sse2";
+    return mismatchBytesSSE2;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    *name = "neon";
+    return mismatchBytesNEON;
+#else
+    *name = "scalar";
+    return mismatchBytesScalar;
+#endif
+}
+
+static size_t resolveMismatch(const void* a, const void* b, size_t n);
+
+// Start out pointing at the resolver, so the kernel is usable even from
+// other translation units' static initializers. Threads may make their
+// first call at once; each then stores the same kernel.
+static std::atomic<const char*> mismatchName{"unresolved"};
+static std::atomic<MismatchFn> mismatchImpl{resolveMismatch};
+
+static MismatchFn resolveMismatchKernel() {
+    const char* name;
+    auto kernel = selectMismatchKernel(&name);
+    mismatchName.store(name, std::memory_order_relaxed);
+    mismatchImpl.store(kernel, std::memory_order_release);
+    return kernel;
+}
+
+static size_t resolveMismatch(const void* a, const void* b, size_t n) {
+    return resolveMismatchKernel()(a, b, n);
+}
+
+size_t mismatchBytes(const void* a, const void* b, size_t n) {
+    return mismatchImpl.load(std::memory_order_relaxed)(a, b, n);
+}
+
+const char* mismatchKernelName() {
+    if (mismatchImpl.load(std::memory_order_acquire) == resolveMismatch) {
+        resolveMismatchKernel();
+    }
+    return mismatchName.load(std::memory_order_relaxed);
 }
 
 template<typename K>
@@ -52,86 +168,43 @@ K concat(const K& a, const K& b) {
 
 // LeafNode implementation
 template<typename K, typename T>
-LeafNode<K, T>::LeafNode(const K& k, const T& v) : key(k), val(v), nextLeaf(nullptr), prevLeaf(nullptr) {}
+LeafNode<K, T>::LeafNode() : key(), val(), nextLeaf(nullptr), prevLeaf(nullptr), owner(0) {}
 
-// Node implementation
 template<typename K, typename T>
-Node<K, T>::Node() : leaf(nullptr), minLeaf(nullptr), maxLeaf(nullptr), leaves_in_subtree(0) {}
+LeafNode<K, T>::LeafNode(KeyViewOf<K> k, const T& v) : key(k), val(v), nextLeaf(nullptr), prevLeaf(nullptr), owner(0) {}
 
+// Node implementation
 template<typename K, typename T>
-std::shared_ptr<Node<K, T>> Node<K, T>::getEdge(typename K::value_type label, int* out_index) const {
-    if (edges.empty()) {
-        if (out_index) *out_index = -1;
-        return nullptr;
-    }
+Node<K, T>::Node() : leaf(nullptr), minLeaf(nullptr), maxLeaf(nullptr), leaves_in_subtree(0), owner(0) {}
 
-    auto it = std::lower_bound(edges.begin(), edges.end(), label,
-        [](const Edge<K, T>& e, typename K::value_type l) { return e.label < l; });
-    
-    if (it != edges.end() && it->label == label) {
-        if (out_index) *out_index = std::distance(edges.begin(), it);
-        return it->node;
-    }
-    
-    if (out_index) *out_index = -1;
-    return nullptr;
+template<typename K, typename T>
+Node<K, T>* Node<K, T>::getEdge(typename K::value_type label) const {
+    return edges.find(static_cast<uint8_t>(label));
 }
 
 template<typename K, typename T>
 void Node<K, T>::replaceEdge(const Edge<K, T>& e) {
-    if (edges.empty()) {
-        addEdge(e);
-        return;
-    }
-
-    auto it = std::lower_bound(edges.begin(), edges.end(), e.label,
-        [](const Edge<K, T>& edge, typename K::value_type label) { return edge.label < label; });
-    
-    if (it != edges.end() && it->label == e.label) {
-        *it = e;
-    } else {
+    if (!edges.replace(static_cast<uint8_t>(e.label), e.node)) {
         addEdge(e);
     }
 }
 
 template<typename K, typename T>
 void Node<K, T>::delEdge(typename K::value_type label) {
-    if (edges.empty()) {
-        return;
-    }
-
-    auto it = std::lower_bound(edges.begin(), edges.end(), label,
-        [](const Edge<K, T>& edge, typename K::value_type l) { return edge.label < l; });
-    
-    if (it != edges.end() && it->label == label) {
-        edges.erase(it);
-    }
+    edges.erase(static_cast<uint8_t>(label));
 }
 
 template<typename K, typename T>
 void Node<K, T>::addEdge(const Edge<K, T>& e) {
-    auto it = std::lower_bound(edges.begin(), edges.end(), e,
-        [](const Edge<K, T>& a, const Edge<K, T>& b) { return a.label < b.label; });
-    
-    edges.insert(it, e);
+    edges.insert(static_cast<uint8_t>(e.label), e.node);
 }
 
 template<typename K, typename T>
-std::shared_ptr<Node<K, T>> Node<K, T>::getLowerBoundEdge(typename K::value_type label, int* out_index) const {
-    if (edges.empty()) {
-        if (out_index) *out_index = -1;
-        return nullptr;
-    }
-
-    auto it = std::lower_bound(edges.begin(), edges.end(), label,
-        [](const Edge<K, T>& e, typename K::value_type l) { return e.label < l; });
-    
-    if (out_index) *out_index = std::distance(edges.begin(), it);
-    
+Node<K, T>* Node<K, T>::getLowerBoundEdge(typename K::value_type label) const {
+    auto it = edges.lowerBound(static_cast<uint8_t>(label));
     if (it != edges.end()) {
-        return it->node;
+        return (*it).node;
     }
-    
     return nullptr;
 }
 
@@ -139,7 +212,7 @@ template<typename K, typename T>
 LeafNode<K, T>* Node<K, T>::minimumLeaf(bool* found) const {
     if (leaf) {
         if (found) *found = true;
-        return leaf.get();
+        return leaf;
     }
     
     if (edges.empty()) {
@@ -147,14 +220,14 @@ LeafNode<K, T>* Node<K, T>::minimumLeaf(bool* found) const {
         return nullptr;
     }
     
-    return edges[0].node->minimumLeaf(found);
+    return edges.front()->minimumLeaf(found);
 }
 
 template<typename K, typename T>
 LeafNode<K, T>* Node<K, T>::maximumLeaf(bool* found) const {
     if (leaf) {
         if (found) *found = true;
-        return leaf.get();
+        return leaf;
     }
     
     if (edges.empty()) {
@@ -162,27 +235,26 @@ LeafNode<K, T>* Node<K, T>::maximumLeaf(bool* found) const {
         return nullptr;
     }
     
-    return edges.back().node->maximumLeaf(found);
+    return edges.back()->maximumLeaf(found);
 }
 
 template<typename K, typename T>
 void Node<K, T>::updateMinMaxLeaves() {
-    leaves_in_subtree = 0;
     minLeaf = nullptr;
     maxLeaf = nullptr;
     
     if (leaf != nullptr) {
-        minLeaf = leaf.get();
+        minLeaf = leaf;
     } else if (!edges.empty()) {
-        minLeaf = edges[0].node->minLeaf;
+        minLeaf = edges.front()->minLeaf;
     }
     
     if (!edges.empty()) {
-        maxLeaf = edges.back().node->maxLeaf;
+        maxLeaf = edges.back()->maxLeaf;
     }
     
     if (maxLeaf == nullptr && leaf != nullptr) {
-        maxLeaf = leaf.get();
+        maxLeaf = leaf;
     }
 }
 
@@ -196,27 +268,32 @@ void Node<K, T>::computeLinks() {
     }
     if (!edges.empty()) {
         // Link the current node's leaf to the first child's minLeaf if they're different
-        if (minLeaf != nullptr && minLeaf != edges[0].node->minLeaf) {
-            minLeaf->nextLeaf = edges[0].node->minLeaf;
-            if (edges[0].node->minLeaf != nullptr) {
-                edges[0].node->minLeaf->prevLeaf = minLeaf;
+        auto first = edges.front();
+        if (minLeaf != nullptr && minLeaf != first->minLeaf) {
+            minLeaf->nextLeaf = first->minLeaf;
+            if (first->minLeaf != nullptr) {
+                first->minLeaf->prevLeaf = minLeaf;
             }
         }
     }
     // Link consecutive child nodes and count leaves - use direct property access
-    for (size_t i = 0; i < edges.size(); i++) {
-        leaves_in_subtree += edges[i].node->leaves_in_subtree;
-        auto maxLFirst = edges[i].node->maxLeaf;
-        LeafNode<K, T>* minLSecond = nullptr;
-        if (i + 1 < edges.size()) {
-            minLSecond = edges[i + 1].node->minLeaf;
-        }
-        if (maxLFirst != nullptr) {
-            maxLFirst->nextLeaf = minLSecond;
-        }
-        if (minLSecond != nullptr) {
-            minLSecond->prevLeaf = maxLFirst;
+    Node<K, T>* prev = nullptr;
+    for (const auto& edge : edges) {
+        leaves_in_subtree += edge.node->leaves_in_subtree;
+        if (prev) {
+            auto maxLFirst = prev->maxLeaf;
+            auto minLSecond = edge.node->minLeaf;
+            if (maxLFirst != nullptr) {
+                maxLFirst->nextLeaf = minLSecond;
+            }
+            if (minLSecond != nullptr) {
+                minLSecond->prevLeaf = maxLFirst;
+            }
         }
+        prev = edge.node;
+    }
+    if (prev && prev->maxLeaf) {
+        prev->maxLeaf->nextLeaf = nullptr;
     }
 }
 
@@ -226,54 +303,58 @@ bool Node<K, T>::isLeaf() const {
 }
 
 template<typename K, typename T>
-bool Node<K, T>::Get(const K& search, T& result) const {
-    if (search.empty()) {
-        if (leaf) {
-            result = leaf->val;
-            return true;
-        }
-        return false;
+bool Node<K, T>::Get(KeyViewOf<K> search, T& result) const {
+    auto leafNode = findLeaf(search);
+    if (leafNode) {
+        result = leafNode->val;
+        return true;
     }
+    return false;
+}
 
-    int idx;
-    auto child = getEdge(search[0], &idx);
-    if (child && hasPrefix(search, child->prefix)) {
-        K newSearch(search.begin() + child->prefix.size(), search.end());
-        return child->Get(newSearch, result);
+template<typename K, typename T>
+LongestPrefixResult<K, T> Node<K, T>::LongestPrefix(KeyViewOf<K> search) const {
+    auto last = longestPrefixLeaf(search);
+    if (last) {
+        return {last->getKey(), last->val, true};
     }
-    
-    return false;
+    T zero{};
+    return {K{}, zero, false};
+}
+
+template<typename K, typename T>
+const LeafNode<K, T>* Node<K, T>::findLeaf(KeyViewOf<K> search) const {
+    const Node<K, T>* n = this;
+
+    while (!search.empty()) {
+        n = n->getEdge(search[0]);
+        if (!n || !hasPrefix(search, n->prefix)) {
+            return nullptr;
+        }
+        search = search.substr(n->prefix.size());
+    }
+    return n->leaf;
 }
 
 template<typename K, typename T>
-LongestPrefixResult<K, T> Node<K, T>::LongestPrefix(const K& search) const {
+const LeafNode<K, T>* Node<K, T>::longestPrefixLeaf(KeyViewOf<K> search) const {
     const Node<K, T>* n = this;
-    LeafNode<K, T>* last = nullptr;
-    K remaining = search;
+    const LeafNode<K, T>* last = nullptr;
 
     while (true) {
         if (n->isLeaf()) {
-            last = n->leaf.get();
+            last = n->leaf;
         }
-        if (remaining.empty()) {
+        if (search.empty()) {
             break;
         }
-        auto next = n->getEdge(remaining[0]);
-        if (!next) {
+        n = n->getEdge(search[0]);
+        if (!n || !hasPrefix(search, n->prefix)) {
             break;
         }
-        if (hasPrefix(remaining, next->prefix)) {
-            remaining = K(remaining.begin() + next->prefix.size(), remaining.end());
-            n = next.get();
-        } else {
-            break;
-        }
-    }
-    if (last) {
-        return {last->key, last->val, true};
+        search = search.substr(n->prefix.size());
     }
-    T zero{};
-    return {K{}, zero, false};
+    return last;
 }
 
 template<typename K, typename T>
@@ -283,20 +364,20 @@ std::tuple<K, T, bool> Node<K, T>::GetAtIndex(int index) const {
 
 template<typename K, typename T>
 std::tuple<K, T, bool> Node<K, T>::SearchIndex(int idx) const {
-    if (idx == 0 && isLeaf()) {
-        return {leaf->key, leaf->val, true};
-    }
-    
-    if (isLeaf()) {
-        idx--;
-    }
-    
-    if (leaves_in_subtree > idx) {
-        auto [nextNodeIdx, nextNode] = getNextIndexEdge(idx);
-        for (int itr = 0; itr < nextNodeIdx; itr++) {
-            idx -= edges[itr].node->leaves_in_subtree;
+    const Node<K, T>* n = this;
+    while (n) {
+        if (idx == 0 && n->isLeaf()) {
+            return {n->leaf->getKey(), n->leaf->val, true};
+        }
+        
+        if (n->isLeaf()) {
+            idx--;
+        }
+        
+        if (idx < 0 || n->leaves_in_subtree <= idx) {
+            break;
         }
-        return nextNode->SearchIndex(idx);
+        std::tie(idx, n) = n->getNextIndexEdge(idx);
     }
     
     T zero{};
@@ -304,13 +385,13 @@ std::tuple<K, T, bool> Node<K, T>::SearchIndex(int idx) const {
 }
 
 template<typename K, typename T>
-std::tuple<int, std::shared_ptr<Node<K, T>>> Node<K, T>::getNextIndexEdge(int idx) const {
-    int cumulativeIndex = 0;
-    for (size_t iterIndex = 0; iterIndex < edges.size(); iterIndex++) {
-        cumulativeIndex += edges[iterIndex].node->leaves_in_subtree;
-        if (cumulativeIndex > idx) {
-            return {static_cast<int>(iterIndex), edges[iterIndex].node};
+std::tuple<int, Node<K, T>*> Node<K, T>::getNextIndexEdge(int idx) const {
+    for (const auto& edge : edges) {
+        int count = edge.node->leaves_in_subtree;
+        if (idx < count) {
+            return {idx, edge.node};
         }
+        idx -= count;
     }
     return {-1, nullptr};
 }
@@ -325,9 +406,5 @@ template class LeafNode<std::string, int>;
 template class LeafNode<std::string, double>;
 template class LeafNode<std::vector<uint8_t>, std::string>;
 
-template bool hasPrefix<std::string>(const std::string&, const std::string&);
-template bool hasPrefix<std::vector<uint8_t>>(const std::vector<uint8_t>&, const std::vector<uint8_t>&);
-template int longestPrefix<std::string>(const std::string&, const std::string&);
-template int longestPrefix<std::vector<uint8_t>>(const std::vector<uint8_t>&, const std::vector<uint8_t>&);
 template std::string concat<std::string>(const std::string&, const std::string&);
 template std::vector<uint8_t> concat<std::vector<uint8_t>>(const std::vector<uint8_t>&, const std::vector<uint8_t>&); 
\ No newline at end of file
@@ -5,6 +5,7 @@
 #ifndef NODE_H
 #define NODE_H
 
+#include "edge_table.hpp"
 #include <regex.h>  // if you use regex_t for patterns
 #include <vector>
 #include <memory>
@@ -12,6 +13,10 @@
 #include <cstring>
 #include <optional>
 #include <tuple>
+#include <string>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
 
 // Forward declarations
 template<typename K, typename T>
@@ -20,11 +25,277 @@ class Node;
 template<typename K, typename T>
 class LeafNode;
 
+// IsContiguousOf is true for containers and views (std::string, string_view,
+// std::vector, span, ...) that expose data()/size() over elements of type C
+template<typename V, typename C, typename = void>
+struct IsContiguousOf : std::false_type {};
+
+template<typename V, typename C>
+struct IsContiguousOf<V, C, std::void_t<decltype(std::declval<const V&>().data()),
+                                        decltype(std::declval<const V&>().size())>>
+    : std::is_same<std::remove_cv_t<std::remove_pointer_t<decltype(std::declval<const V&>().data())>>, C> {};
+
+// KeyView is a non-owning view over a contiguous run of key elements. Lookups
+// walk the tree by advancing a view over the caller's key instead of copying
+// the remaining suffix at every level.
+template<typename C>
+struct KeyView {
+    const C* ptr;
+    size_t len;
+
+    KeyView() : ptr(nullptr), len(0) {}
+    KeyView(const C* p, size_t n) : ptr(p), len(n) {}
+
+    template<typename V, typename = std::enable_if_t<IsContiguousOf<V, C>::value>>
+    KeyView(const V& v) : ptr(v.data()), len(v.size()) {}
+
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+    const C* data() const { return ptr; }
+    const C* begin() const { return ptr; }
+    const C* end() const { return ptr + len; }
+    const C& operator[](size_t i) const { return ptr[i]; }
+
+    // Returns the view with the first n elements removed
+    KeyView substr(size_t n) const { return KeyView(ptr + n, len - n); }
+
+    // Element-wise equality, so a view can be compared with a key
+    friend bool operator==(KeyView a, KeyView b) {
+        return a.len == b.len && std::equal(a.begin(), a.end(), b.begin());
+    }
+
+    friend bool operator!=(KeyView a, KeyView b) {
+        return !(a == b);
+    }
+};
+
+// KeyViewOf is the view type used to search a tree keyed by K
+template<typename K>
+using KeyViewOf = KeyView<typename K::value_type>;
+
+// Byte comparison kernels, implemented in node.cpp. Each returns the index
+// of the first byte at which a and b differ, or n if the first n bytes are
+// equal. mismatchBytes dispatches on first use to the widest kernel the CPU
+// supports (AVX2 or SSE2 on x86-64, NEON on arm64) and falls back to the
+// word-at-a-time scalar kernel elsewhere.
+size_t mismatchBytes(const void* a, const void* b, size_t n);
+size_t mismatchBytesScalar(const void* a, const void* b, size_t n);
+size_t mismatchBytesSSE2(const void* a, const void* b, size_t n);
+size_t mismatchBytesAVX2(const void* a, const void* b, size_t n);
+size_t mismatchBytesNEON(const void* a, const void* b, size_t n);
+
+// Name of the kernel mismatchBytes dispatches to
+const char* mismatchKernelName();
+
+// Most compressed edges are only a few bytes long, so short compares are
+// done inline a word at a time and only longer ones go through the kernel
+inline size_t mismatchPrefix(const void* a, const void* b, size_t n) {
+    if (n >= 16) {
+        return mismatchBytes(a, b, n);
+    }
+    auto pa = static_cast<const unsigned char*>(a);
+    auto pb = static_cast<const unsigned char*>(b);
+    size_t i = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if (n >= 8) {
+        uint64_t x, y;
+        std::memcpy(&x, pa, 8);
+        std::memcpy(&y, pb, 8);
+        if (x != y) {
+            return __builtin_ctzll(x ^ y) >> 3;
+        }
+        i = 8;
+    }
+#endif
+    while (i < n && pa[i] == pb[i]) {
+        i++;
+    }
+    return i;
+}
+
+// Returns true if str starts with prefix. Works on any pair of byte
+// sequences exposing data() and size(): keys, prefixes and KeyViews.
+template<typename S, typename P>
+inline bool hasPrefix(const S& str, const P& prefix) {
+    static_assert(sizeof(*prefix.data()) == 1, "hasPrefix compares byte keys");
+    if (prefix.size() > str.size()) {
+        return false;
+    }
+    return mismatchPrefix(str.data(), prefix.data(), prefix.size()) == prefix.size();
+}
+
+// Returns the length of the longest common prefix of k1 and k2
+template<typename A, typename B>
+inline int longestPrefix(const A& k1, const B& k2) {
+    static_assert(sizeof(*k1.data()) == 1, "longestPrefix compares byte keys");
+    return static_cast<int>(mismatchPrefix(k1.data(), k2.data(), std::min(k1.size(), k2.size())));
+}
+
+// Append-only store for leaf keys and long node prefixes. Bytes are copied
+// into large chunks that never move, so leaves and nodes can refer to them
+// with a plain view. Space freed by short keys is recycled by exact length,
+// which covers the common case of fixed-width keys being deleted and
+// re-inserted; anything else is returned when the buffer is destroyed.
+template<typename C>
+class KeyBuffer {
+private:
+    static constexpr size_t kChunkSize = 64 * 1024;
+    static constexpr size_t kMaxRecycledLen = 64;
+
+    std::vector<std::unique_ptr<C[]>> chunks;
+    size_t used = kChunkSize;
+    std::vector<std::vector<C*>> freeByLen = std::vector<std::vector<C*>>(kMaxRecycledLen + 1);
+    size_t liveElements = 0;
+    size_t reservedElements = 0;
+
+    C* allocate(size_t n) {
+        if (n <= kMaxRecycledLen && !freeByLen[n].empty()) {
+            C* p = freeByLen[n].back();
+            freeByLen[n].pop_back();
+            return p;
+        }
+        if (n > kChunkSize / 4) {
+            // Oversized keys get a chunk of their own, kept behind the
+            // current one so its free space is not abandoned
+            chunks.emplace_back(new C[n]);
+            reservedElements += n;
+            if (chunks.size() > 1) {
+                std::swap(chunks[chunks.size() - 1], chunks[chunks.size() - 2]);
+                return chunks[chunks.size() - 2].get();
+            }
+            used = kChunkSize;
+            return chunks.back().get();
+        }
+        if (used + n > kChunkSize) {
+            chunks.emplace_back(new C[kChunkSize]);
+            reservedElements += kChunkSize;
+            used = 0;
+        }
+        C* p = chunks.back().get() + used;
+        used += n;
+        return p;
+    }
+
+public:
+    KeyBuffer() = default;
+    KeyBuffer(const KeyBuffer&) = delete;
+    KeyBuffer& operator=(const KeyBuffer&) = delete;
+
+    // Copies the bytes into the buffer and returns a view of the stored bytes
+    KeyView<C> store(KeyView<C> key) {
+        if (key.empty()) {
+            return KeyView<C>();
+        }
+        C* p = allocate(key.size());
+        std::memcpy(p, key.data(), key.size() * sizeof(C));
+        liveElements += key.size();
+        return KeyView<C>(p, key.size());
+    }
+
+    // Marks stored bytes as no longer referenced
+    void release(KeyView<C> key) {
+        if (key.empty()) {
+            return;
+        }
+        liveElements -= key.size();
+        if (key.size() <= kMaxRecycledLen) {
+            freeByLen[key.size()].push_back(const_cast<C*>(key.data()));
+        }
+    }
+
+    // Number of elements currently referenced by leaves and nodes
+    size_t liveSize() const { return liveElements; }
+
+    // Number of key elements the buffer has reserved
+    size_t reservedSize() const { return reservedElements; }
+
+    // Takes over the counts of a buffer whose bytes are now referenced from
+    // this one's tree
+    void absorbCounts(const KeyBuffer& other) {
+        liveElements += other.liveElements;
+        reservedElements += other.reservedElements;
+    }
+};
+
+// NodePrefix is the compressed edge label of a node. Prefixes of up to
+// kInlineCapacity elements are stored inline; longer ones are spilled to the
+// tree's KeyBuffer, with their first kInlineCapacity elements still cached
+// inline so most mismatches are found without following the pointer.
+// Assigning a prefix needs the buffer, so only the tree's transactions do it.
+template<typename C>
+class NodePrefix {
+public:
+    static constexpr size_t kInlineCapacity = 12;
+
+private:
+    uint32_t len = 0;
+    C head[kInlineCapacity];
+    const C* spilled = nullptr;
+
+    bool isSpilled() const { return len > kInlineCapacity; }
+
+public:
+    NodePrefix() = default;
+
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+    const C* data() const { return isSpilled() ? spilled : head; }
+    const C* begin() const { return data(); }
+    const C* end() const { return data() + len; }
+    const C& operator[](size_t i) const { return i < kInlineCapacity ? head[i] : spilled[i]; }
+
+    // Replaces the prefix with bytes, which may alias the current prefix
+    void assign(KeyView<C> bytes, KeyBuffer<C>& buffer) {
+        static_assert(sizeof(C) == 1, "NodePrefix stores byte keys");
+        KeyView<C> old = isSpilled() ? KeyView<C>(spilled, len) : KeyView<C>();
+        if (bytes.size() > kInlineCapacity) {
+            spilled = buffer.store(bytes).data();
+        }
+        // memmove because bytes may be a slice of head
+        std::memmove(head, bytes.data(), std::min(bytes.size(), kInlineCapacity));
+        len = static_cast<uint32_t>(bytes.size());
+        buffer.release(old);
+    }
+
+    // Returns the spilled bytes, if any, to the buffer and empties the prefix
+    void release(KeyBuffer<C>& buffer) {
+        if (isSpilled()) {
+            buffer.release(KeyView<C>(spilled, len));
+        }
+        len = 0;
+        spilled = nullptr;
+    }
+
+    // Length of the common prefix of this prefix and key. The cached head is
+    // compared first and the spilled copy is only read past it.
+    size_t commonPrefix(KeyView<C> key) const {
+        size_t n = std::min<size_t>(len, key.size());
+        size_t h = std::min(n, kInlineCapacity);
+        size_t m = mismatchPrefix(head, key.data(), h);
+        if (m < h || n == h) {
+            return m;
+        }
+        return h + mismatchPrefix(spilled + h, key.data() + h, n - h);
+    }
+};
+
+// hasPrefix and longestPrefix against a node prefix go through its cached
+// head rather than data()
+template<typename S, typename C>
+inline bool hasPrefix(const S& str, const NodePrefix<C>& prefix) {
+    return prefix.size() <= str.size() && prefix.commonPrefix(KeyView<C>(str)) == prefix.size();
+}
+
+template<typename A, typename C>
+inline int longestPrefix(const A& k1, const NodePrefix<C>& k2) {
+    return static_cast<int>(k2.commonPrefix(KeyView<C>(k1)));
+}
+
 // Edge structure
 template<typename K, typename T>
 struct Edge {
     typename K::value_type label;
-    std::shared_ptr<Node<K, T>> node;
+    Node<K, T>* node;
 };
 
 // Result structure for LongestPrefix
@@ -35,35 +306,43 @@ struct LongestPrefixResult {
     bool found;
 };
 
-// LeafNode definition
+// LeafNode definition. The leaf does not own its key: key views bytes held
+// in the tree's KeyBuffer, which keeps them at a stable address for as long
+// as the leaf is in a tree.
 template<typename K, typename T>
 class LeafNode {
 public:
-    K key;                  // key data
+    KeyViewOf<K> key;       // key data, owned by the tree's key buffer
     T val;                  // value
     LeafNode<K, T>* nextLeaf;  // Use raw pointers for internal links
     LeafNode<K, T>* prevLeaf;  // Use raw pointers for internal links
+    uint64_t owner;            // id of the tree version that created the leaf
+
+    LeafNode();
+    LeafNode(KeyViewOf<K> k, const T& v);
 
-    LeafNode(const K& k, const T& v);
+    // Returns a copy of the key
+    K getKey() const { return K(key.begin(), key.end()); }
 };
 
 // Node structure
 template<typename K, typename T>
 class Node {
 public:
-    std::shared_ptr<LeafNode<K, T>> leaf;
+    LeafNode<K, T>* leaf;
     LeafNode<K, T>* minLeaf;  // Use raw pointers for internal links
     LeafNode<K, T>* maxLeaf;  // Use raw pointers for internal links
-    K prefix;
-    std::vector<Edge<K, T>> edges;
+    NodePrefix<typename K::value_type> prefix;
+    EdgeTable<Node<K, T>> edges;
     int leaves_in_subtree;
+    uint64_t owner;  // id of the tree version that created the node
 
     Node();
 
     // Returns the edge with the given label, or nullptr if not found
-    std::shared_ptr<Node<K, T>> getEdge(typename K::value_type label, int* out_index = nullptr) const;
+    Node<K, T>* getEdge(typename K::value_type label) const;
 
-    // Replaces an edge with the given label
+    // Replaces an edge with the given label, adding it if missing
     void replaceEdge(const Edge<K, T>& e);
 
     // Deletes an edge with the given label
@@ -73,7 +352,7 @@ public:
     void addEdge(const Edge<K, T>& e);
 
     // Returns the lower bound edge for the given label
-    std::shared_ptr<Node<K, T>> getLowerBoundEdge(typename K::value_type label, int* out_index) const;
+    Node<K, T>* getLowerBoundEdge(typename K::value_type label) const;
 
     // Returns the minimum leaf in the node
     LeafNode<K, T>* minimumLeaf(bool* found = nullptr) const;
@@ -91,11 +370,19 @@ public:
     bool isLeaf() const;
 
     // Gets a value from the node given a key
-    bool Get(const K& search, T& result) const;
+    bool Get(KeyViewOf<K> search, T& result) const;
 
     // LongestPrefix is like Get, but instead of an exact match,
     // it will return the longest prefix match.
-    LongestPrefixResult<K, T> LongestPrefix(const K& search) const;
+    LongestPrefixResult<K, T> LongestPrefix(KeyViewOf<K> search) const;
+
+    // findLeaf walks down from this node and returns the leaf stored under
+    // search, or nullptr. It neither allocates nor copies the key.
+    const LeafNode<K, T>* findLeaf(KeyViewOf<K> search) const;
+
+    // longestPrefixLeaf returns the leaf of the longest key that is a
+    // prefix of search, or nullptr. It neither allocates nor copies the key.
+    const LeafNode<K, T>* longestPrefixLeaf(KeyViewOf<K> search) const;
 
     // GetAtIndex returns the key and value at the specified index
     std::tuple<K, T, bool> GetAtIndex(int index) const;
@@ -103,17 +390,11 @@ public:
     // SearchIndex searches for the key and value at the specified index
     std::tuple<K, T, bool> SearchIndex(int idx) const;
 
-    // getNextIndexEdge finds the next edge that contains the index
-    std::tuple<int, std::shared_ptr<Node<K, T>>> getNextIndexEdge(int idx) const;
+    // getNextIndexEdge finds the child whose subtree contains the index and
+    // returns the index relative to that child
+    std::tuple<int, Node<K, T>*> getNextIndexEdge(int idx) const;
 };
 
-// Helper function declarations
-template<typename K>
-bool hasPrefix(const K& str, const K& prefix);
-
-template<typename K>
-int longestPrefix(const K& k1, const K& k2);
-
 template<typename K>
 K concat(const K& a, const K& b);
 
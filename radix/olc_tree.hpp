@@ -0,0 +1,772 @@
+//
+// Created by Ashesh Vidyut on 22/03/25.
+//
+
+#ifndef OLC_TREE_H
+#define OLC_TREE_H
+
+#include "concurrent_tree.hpp"
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// VersionLock is the per-node lock of an OlcTree. The word holds a version
+// counter above two flag bits: bit 1 is set while a writer holds the lock,
+// bit 0 once the node has been replaced. Writers read versions on the way
+// down without locking and only lock a node if its version is unchanged.
+class VersionLock {
+private:
+    static constexpr uint64_t kObsolete = 1;
+    static constexpr uint64_t kLocked = 2;
+
+    std::atomic<uint64_t> word{0};
+
+public:
+    static bool isObsolete(uint64_t version) {
+        return version & kObsolete;
+    }
+
+    // Returns the version once no writer holds the lock
+    uint64_t stableVersion() const {
+        uint64_t v = word.load(std::memory_order_acquire);
+        while (v & kLocked) {
+            std::this_thread::yield();
+            v = word.load(std::memory_order_acquire);
+        }
+        return v;
+    }
+
+    // Takes the lock if the node is still at version and not obsolete
+    bool tryLock(uint64_t version) {
+        return !isObsolete(version) &&
+               word.compare_exchange_strong(version, version + kLocked, std::memory_order_acquire);
+    }
+
+    // Releases the lock; the carry out of the lock bit bumps the version
+    void unlock() {
+        word.fetch_add(kLocked, std::memory_order_release);
+    }
+
+    // Releases the lock and marks the node replaced
+    void unlockObsolete() {
+        word.fetch_add(kLocked | kObsolete, std::memory_order_release);
+    }
+};
+
+// OlcTree is a radix tree that any number of threads insert into, delete
+// from and read at once, for write-heavy tables such as sessions keyed by
+// UUID. It follows the ROWEX scheme of the concurrent Adaptive Radix Tree:
+//
+//   - A published node never changes, except for its child slots, which
+//     are swapped atomically. A write builds a copy of the one node whose
+//     leaf or label set changes and swaps it into the parent's slot.
+//   - Writers descend optimistically, recording node versions, and lock
+//     only the parent whose slot they swap and the nodes they replace. A
+//     lock is taken only if the version is unchanged, so a write never acts
+//     on a path that changed under it; it restarts instead.
+//   - Readers take no locks and validate nothing: every node they reach is
+//     complete. Replaced nodes are freed through an EpochManager once no
+//     reader or writer can still hold them.
+//
+// Per-node leaf links and subtree counts would put every write on the same
+// path to the root, so OlcTree does not keep them. Each writer counts the
+// keys it added and removed, and len() sums the counts. Ordered scans go
+// through a View, whose Iterator descends through the nodes; toTree()
+// builds a regular Tree, with links and counts, for index-based access.
+//
+// Threads use the tree through a handle: reader() for lookups, writer()
+// for lookups and writes. Create one per thread and keep it.
+template<typename K, typename T>
+class OlcTree {
+private:
+    using C = typename K::value_type;
+
+    struct OlcNode : Node<K, T> {
+        VersionLock lock;
+
+        OlcNode() = default;
+
+        // The copy starts unlocked at version 0
+        OlcNode(const OlcNode& other) : Node<K, T>(other) {}
+    };
+
+    struct Retired {
+        OlcNode* node;
+        LeafNode<K, T>* leaf;
+        bool releaseBytes;  // false when a copy took over the prefix or key
+        uint64_t epoch;
+    };
+
+    // State of one writer thread. The bytes of keys and spilled prefixes
+    // are stored in the writer's own buffer, and freed bytes are recycled
+    // through the buffer of whichever writer frees them. Every buffer lives
+    // as long as the tree, so a state is reused rather than freed when its
+    // writer goes away.
+    struct WriterState {
+        KeyBuffer<C> keys;
+        std::vector<Retired> retired;
+        size_t reclaimAt = kReclaimBatch;
+        std::atomic<int64_t> added{0};  // keys inserted minus keys deleted
+        std::atomic<bool> claimed{false};
+        WriterState* next = nullptr;
+    };
+
+    static constexpr size_t kReclaimBatch = 64;
+
+    EpochManager epochs;
+    VersionLock rootLock;
+    std::atomic<OlcNode*> root;
+    std::atomic<WriterState*> writers{nullptr};
+
+    // Pins the epoch for the duration of one operation
+    struct Pin {
+        EpochManager::Reader& reader;
+
+        explicit Pin(EpochManager::Reader& r) : reader(r) {
+            reader.enter();
+        }
+
+        ~Pin() {
+            reader.exit();
+        }
+    };
+
+    static OlcNode* child(const OlcNode* n, C label) {
+        auto slot = n->edges.slot(label);
+        return slot ? static_cast<OlcNode*>(__atomic_load_n(slot, __ATOMIC_ACQUIRE)) : nullptr;
+    }
+
+    // Parent nullptr stands for the root slot
+    VersionLock& lockOf(OlcNode* parent) {
+        return parent ? parent->lock : rootLock;
+    }
+
+    void setChild(OlcNode* parent, C label, OlcNode* n) {
+        if (!parent) {
+            root.store(n, std::memory_order_release);
+            return;
+        }
+        auto slot = const_cast<Node<K, T>**>(parent->edges.slot(label));
+        __atomic_store_n(slot, static_cast<Node<K, T>*>(n), __ATOMIC_RELEASE);
+    }
+
+    // Locks each (lock, version) pair in order, top-down. On a version
+    // mismatch the locks already taken are released and false returned.
+    static bool lockAll(std::initializer_list<std::pair<VersionLock*, uint64_t>> locks) {
+        size_t taken = 0;
+        for (const auto& [lock, version] : locks) {
+            if (!lock->tryLock(version)) {
+                for (auto it = locks.begin(); taken > 0; ++it, --taken) {
+                    it->first->unlock();
+                }
+                return false;
+            }
+            taken++;
+        }
+        return true;
+    }
+
+    static OlcNode* newLeafNode(WriterState& w, KeyViewOf<K> key, KeyViewOf<K> prefix, const T& v) {
+        auto n = new OlcNode();
+        n->leaf = new LeafNode<K, T>(w.keys.store(key), v);
+        n->prefix.assign(prefix, w.keys);
+        return n;
+    }
+
+    // Copy of extra, n's only child, taking over n's place: its prefix is
+    // n's prefix followed by its own
+    static OlcNode* mergedCopy(WriterState& w, const OlcNode* n, const OlcNode* extra) {
+        K bytes(n->prefix.begin(), n->prefix.end());
+        bytes.insert(bytes.end(), extra->prefix.begin(), extra->prefix.end());
+        auto merged = new OlcNode(*extra);
+        merged->prefix = NodePrefix<C>();
+        merged->prefix.assign(KeyViewOf<K>(bytes), w.keys);
+        return merged;
+    }
+
+    // Queues replaced nodes and leaves for release. The fence orders the
+    // swaps that unlinked them before the epoch read that tags them.
+    void retire(WriterState& w, std::initializer_list<Retired> objects) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint64_t epoch = epochs.current();
+        for (auto r : objects) {
+            if (r.node || r.leaf) {
+                r.epoch = epoch;
+                w.retired.push_back(r);
+            }
+        }
+    }
+
+    static void release(WriterState& w, const Retired& r) {
+        if (r.node) {
+            if (r.releaseBytes) {
+                r.node->prefix.release(w.keys);
+            }
+            delete r.node;
+        }
+        if (r.leaf) {
+            if (r.releaseBytes) {
+                w.keys.release(r.leaf->key);
+            }
+            delete r.leaf;
+        }
+    }
+
+    // Frees what w retired before the oldest epoch still in use. Called
+    // outside the writer's own pin.
+    void reclaim(WriterState& w) {
+        if (w.retired.size() < w.reclaimAt) {
+            return;
+        }
+        epochs.advance();
+        uint64_t oldest = epochs.oldestActive();
+        size_t kept = 0;
+        for (const auto& r : w.retired) {
+            if (r.epoch < oldest) {
+                release(w, r);
+            } else {
+                w.retired[kept++] = r;
+            }
+        }
+        w.retired.resize(kept);
+        // Objects a slow reader still holds are not rescanned on every write
+        w.reclaimAt = kept + kReclaimBatch;
+    }
+
+    WriterState* claimWriter() {
+        for (auto w = writers.load(); w; w = w->next) {
+            bool expected = false;
+            if (!w->claimed.load() && w->claimed.compare_exchange_strong(expected, true)) {
+                return w;
+            }
+        }
+        auto w = new WriterState();
+        w->claimed.store(true);
+        w->next = writers.load();
+        while (!writers.compare_exchange_weak(w->next, w)) {
+        }
+        return w;
+    }
+
+    const LeafNode<K, T>* findLeaf(KeyViewOf<K> search) const {
+        const OlcNode* n = root.load(std::memory_order_acquire);
+        while (!search.empty()) {
+            n = child(n, search[0]);
+            if (!n || !hasPrefix(search, n->prefix)) {
+                return nullptr;
+            }
+            search = search.substr(n->prefix.size());
+        }
+        return n->leaf;
+    }
+
+    const LeafNode<K, T>* longestPrefixLeaf(KeyViewOf<K> search) const {
+        const OlcNode* n = root.load(std::memory_order_acquire);
+        const LeafNode<K, T>* last = nullptr;
+        while (true) {
+            if (n->leaf) {
+                last = n->leaf;
+            }
+            if (search.empty()) {
+                break;
+            }
+            n = child(n, search[0]);
+            if (!n || !hasPrefix(search, n->prefix)) {
+                break;
+            }
+            search = search.substr(n->prefix.size());
+        }
+        return last;
+    }
+
+    // One attempt at an insert. Returns false if a node on the path changed
+    // before it could be locked, and the insert has to start over.
+    bool tryInsert(WriterState& w, KeyViewOf<K> key, const T& v, std::optional<T>& oldVal) {
+        OlcNode* parent = nullptr;
+        uint64_t parentVersion = rootLock.stableVersion();
+        C label = 0;  // label of n in parent
+        OlcNode* n = root.load(std::memory_order_acquire);
+        KeyViewOf<K> search = key;
+
+        while (true) {
+            uint64_t version = n->lock.stableVersion();
+            if (VersionLock::isObsolete(version)) {
+                return false;
+            }
+
+            // The key ends here: replace n by a copy holding the new leaf
+            if (search.empty()) {
+                if (!lockAll({{&lockOf(parent), parentVersion}, {&n->lock, version}})) {
+                    return false;
+                }
+                auto old = n->leaf;
+                auto copy = new OlcNode(*n);
+                copy->leaf = old ? new LeafNode<K, T>(old->key, v) : new LeafNode<K, T>(w.keys.store(key), v);
+                setChild(parent, label, copy);
+                n->lock.unlockObsolete();
+                lockOf(parent).unlock();
+
+                if (old) {
+                    oldVal = old->val;
+                } else {
+                    w.added.fetch_add(1, std::memory_order_relaxed);
+                }
+                retire(w, {{n, nullptr, false, 0}, {nullptr, old, false, 0}});
+                return true;
+            }
+
+            // No edge for the next byte: replace n by a copy with one
+            C c = search[0];
+            OlcNode* next = child(n, c);
+            if (!next) {
+                if (!lockAll({{&lockOf(parent), parentVersion}, {&n->lock, version}})) {
+                    return false;
+                }
+                auto copy = new OlcNode(*n);
+                copy->edges.insert(c, newLeafNode(w, key, search, v));
+                setChild(parent, label, copy);
+                n->lock.unlockObsolete();
+                lockOf(parent).unlock();
+
+                w.added.fetch_add(1, std::memory_order_relaxed);
+                retire(w, {{n, nullptr, false, 0}});
+                return true;
+            }
+
+            size_t common = next->prefix.commonPrefix(search);
+            if (common == next->prefix.size()) {
+                parent = n;
+                parentVersion = version;
+                label = c;
+                n = next;
+                search = search.substr(common);
+                continue;
+            }
+
+            // The key leaves next's prefix part way: swap a node holding the
+            // common part into n's slot, above a copy of next with the rest
+            uint64_t nextVersion = next->lock.stableVersion();
+            if (!lockAll({{&n->lock, version}, {&next->lock, nextVersion}})) {
+                return false;
+            }
+            auto split = new OlcNode();
+            split->prefix.assign(KeyViewOf<K>(search.data(), common), w.keys);
+            auto moved = new OlcNode(*next);
+            moved->prefix = NodePrefix<C>();
+            moved->prefix.assign(KeyViewOf<K>(next->prefix.data() + common, next->prefix.size() - common), w.keys);
+            split->edges.insert(moved->prefix[0], moved);
+            if (common == search.size()) {
+                split->leaf = new LeafNode<K, T>(w.keys.store(key), v);
+            } else {
+                split->edges.insert(search[common], newLeafNode(w, key, search.substr(common), v));
+            }
+            setChild(n, c, split);
+            next->lock.unlockObsolete();
+            n->lock.unlock();
+
+            w.added.fetch_add(1, std::memory_order_relaxed);
+            retire(w, {{next, nullptr, true, 0}});
+            return true;
+        }
+    }
+
+    // One attempt at a delete, restarted the same way as tryInsert
+    bool tryDel(WriterState& w, KeyViewOf<K> key, std::optional<T>& oldVal) {
+        OlcNode* grandparent = nullptr;
+        uint64_t grandparentVersion = 0;
+        C parentLabel = 0;
+        OlcNode* parent = nullptr;
+        uint64_t parentVersion = rootLock.stableVersion();
+        C label = 0;
+        OlcNode* n = root.load(std::memory_order_acquire);
+        uint64_t version = 0;
+        KeyViewOf<K> search = key;
+
+        while (true) {
+            version = n->lock.stableVersion();
+            if (VersionLock::isObsolete(version)) {
+                return false;
+            }
+            if (search.empty()) {
+                break;
+            }
+            C c = search[0];
+            OlcNode* next = child(n, c);
+            if (!next || !hasPrefix(search, next->prefix)) {
+                return true;
+            }
+            grandparent = parent;
+            grandparentVersion = parentVersion;
+            parentLabel = label;
+            parent = n;
+            parentVersion = version;
+            label = c;
+            n = next;
+            search = search.substr(next->prefix.size());
+        }
+
+        auto leaf = n->leaf;
+        if (!leaf) {
+            return true;
+        }
+
+        if (!parent || n->edges.size() >= 2) {
+            // n stays, without its leaf
+            if (!lockAll({{&lockOf(parent), parentVersion}, {&n->lock, version}})) {
+                return false;
+            }
+            auto copy = new OlcNode(*n);
+            copy->leaf = nullptr;
+            setChild(parent, label, copy);
+            n->lock.unlockObsolete();
+            lockOf(parent).unlock();
+            retire(w, {{n, nullptr, false, 0}, {nullptr, leaf, true, 0}});
+        } else if (n->edges.size() == 1) {
+            // n merges into its only child
+            C childLabel = n->edges.begin().label();
+            OlcNode* only = child(n, childLabel);
+            uint64_t onlyVersion = only->lock.stableVersion();
+            if (!lockAll({{&lockOf(parent), parentVersion}, {&n->lock, version}, {&only->lock, onlyVersion}})) {
+                return false;
+            }
+            setChild(parent, label, mergedCopy(w, n, only));
+            only->lock.unlockObsolete();
+            n->lock.unlockObsolete();
+            lockOf(parent).unlock();
+            retire(w, {{n, nullptr, true, 0}, {only, nullptr, true, 0}, {nullptr, leaf, true, 0}});
+        } else if (grandparent && !parent->leaf && parent->edges.size() == 2) {
+            // Removing n leaves parent with one child: merge them
+            C otherLabel = 0;
+            for (auto it = parent->edges.begin(); it != parent->edges.end(); ++it) {
+                if (it.label() != label) {
+                    otherLabel = it.label();
+                }
+            }
+            OlcNode* other = child(parent, otherLabel);
+            uint64_t otherVersion = other->lock.stableVersion();
+            if (!lockAll({{&grandparent->lock, grandparentVersion},
+                          {&parent->lock, parentVersion},
+                          {&n->lock, version},
+                          {&other->lock, otherVersion}})) {
+                return false;
+            }
+            setChild(grandparent, parentLabel, mergedCopy(w, parent, other));
+            other->lock.unlockObsolete();
+            n->lock.unlockObsolete();
+            parent->lock.unlockObsolete();
+            grandparent->lock.unlock();
+            retire(w, {{parent, nullptr, true, 0}, {n, nullptr, true, 0},
+                       {other, nullptr, true, 0}, {nullptr, leaf, true, 0}});
+        } else {
+            // Drop n's edge from parent
+            if (!lockAll({{&lockOf(grandparent), grandparentVersion},
+                          {&parent->lock, parentVersion},
+                          {&n->lock, version}})) {
+                return false;
+            }
+            auto copy = new OlcNode(*parent);
+            copy->edges.erase(label);
+            setChild(grandparent, parentLabel, copy);
+            n->lock.unlockObsolete();
+            parent->lock.unlockObsolete();
+            lockOf(grandparent).unlock();
+            retire(w, {{parent, nullptr, false, 0}, {n, nullptr, true, 0}, {nullptr, leaf, true, 0}});
+        }
+        oldVal = leaf->val;
+        w.added.fetch_add(-1, std::memory_order_relaxed);
+        return true;
+    }
+
+    std::optional<T> insert(WriterState& w, KeyViewOf<K> key, const T& v) {
+        std::optional<T> oldVal;
+        while (!tryInsert(w, key, v, oldVal)) {
+        }
+        return oldVal;
+    }
+
+    std::optional<T> del(WriterState& w, KeyViewOf<K> key) {
+        std::optional<T> oldVal;
+        while (!tryDel(w, key, oldVal)) {
+        }
+        return oldVal;
+    }
+
+    static void destroy(OlcNode* n) {
+        for (auto it = n->edges.begin(); it != n->edges.end(); ++it) {
+            destroy(static_cast<OlcNode*>((*it).node));
+        }
+        delete n->leaf;
+        delete n;
+    }
+
+public:
+    OlcTree() : root(new OlcNode()) {}
+
+    OlcTree(const OlcTree&) = delete;
+    OlcTree& operator=(const OlcTree&) = delete;
+
+    // No handle may outlive the tree
+    ~OlcTree() {
+        destroy(root.load());
+        auto w = writers.load();
+        while (w) {
+            for (const auto& r : w->retired) {
+                delete r.node;
+                delete r.leaf;
+            }
+            auto next = w->next;
+            delete w;
+            w = next;
+        }
+    }
+
+    // Number of keys, exact once concurrent writes have finished
+    int len() const {
+        int64_t n = 0;
+        for (auto w = writers.load(); w; w = w->next) {
+            n += w->added.load(std::memory_order_relaxed);
+        }
+        return static_cast<int>(n);
+    }
+
+    // Iterator walks the keys in order by descending through the nodes,
+    // loading child slots as lookups do. Run alongside writers it returns
+    // every key present throughout the walk, and any mix of the changes
+    // made during it. It is only valid inside the View it came from, which
+    // keeps the nodes it holds from being freed.
+    class Iterator {
+    private:
+        using EdgeIterator = typename EdgeTable<Node<K, T>>::const_iterator;
+
+        struct Frame {
+            const OlcNode* node;
+            EdgeIterator next;
+            EdgeIterator end;
+        };
+
+        const OlcNode* pending;  // node whose leaf and children come next
+        std::vector<Frame> stack;
+
+        friend class OlcTree;
+
+        explicit Iterator(const OlcNode* n) : pending(n) {}
+
+    public:
+        // Seeks the iterator to the subtree of keys starting with prefix
+        void seekPrefix(KeyViewOf<K> search) {
+            stack.clear();
+            auto n = pending;
+            pending = nullptr;
+            while (n && !search.empty()) {
+                const OlcNode* nextNode = child(n, search[0]);
+                if (!nextNode) {
+                    return;
+                }
+                if (hasPrefix(search, nextNode->prefix)) {
+                    search = search.substr(nextNode->prefix.size());
+                } else if (hasPrefix(nextNode->prefix, search)) {
+                    search = KeyViewOf<K>();
+                } else {
+                    return;
+                }
+                n = nextNode;
+            }
+            pending = n;
+        }
+
+        void seekPrefix(const K& prefix) {
+            seekPrefix(KeyViewOf<K>(prefix));
+        }
+
+        // Returns the next element in order
+        IteratorResult<K, T> next() {
+            IteratorResult<K, T> result;
+            result.found = false;
+
+            while (true) {
+                if (pending) {
+                    auto n = pending;
+                    pending = nullptr;
+                    if (!n->edges.empty()) {
+                        stack.push_back({n, n->edges.begin(), n->edges.end()});
+                    }
+                    if (n->leaf) {
+                        result.key = n->leaf->getKey();
+                        result.val = n->leaf->val;
+                        result.found = true;
+                        return result;
+                    }
+                    continue;
+                }
+                if (stack.empty()) {
+                    return result;
+                }
+                auto& top = stack.back();
+                if (top.next == top.end) {
+                    stack.pop_back();
+                    continue;
+                }
+                pending = child(top.node, top.next.label());
+                ++top.next;
+            }
+        }
+    };
+
+    // View pins the epoch so that ordered scans can hold on to nodes across
+    // calls. Unlike ConcurrentTree's views it is not a consistent version:
+    // writers carry on, and lookups and iterators see their changes as they
+    // land. A view that is kept holds back the release of every node
+    // replaced after it was taken.
+    class View {
+    private:
+        EpochManager::Reader* reader;
+        const OlcTree* tree;
+
+        friend class OlcTree;
+
+        View(EpochManager::Reader& r, const OlcTree& t) : reader(&r), tree(&t) {
+            reader->enter();
+        }
+
+    public:
+        View(const View&) = delete;
+        View& operator=(const View&) = delete;
+
+        ~View() {
+            reader->exit();
+        }
+
+        std::optional<T> Get(KeyViewOf<K> search) const {
+            auto leaf = tree->findLeaf(search);
+            return leaf ? std::optional<T>(leaf->val) : std::nullopt;
+        }
+
+        std::optional<T> Get(const K& search) const {
+            return Get(KeyViewOf<K>(search));
+        }
+
+        Iterator iterator() const {
+            return Iterator(tree->root.load(std::memory_order_acquire));
+        }
+    };
+
+    // Builds a Tree with the current contents, for index-based access such
+    // as GetAtIndex. Run alongside writers it returns what an Iterator
+    // would.
+    Tree<K, T> toTree() {
+        std::vector<std::pair<K, T>> entries;
+        EpochManager::Reader reader(epochs);
+        {
+            View view(reader, *this);
+            auto it = view.iterator();
+            for (auto res = it.next(); res.found; res = it.next()) {
+                entries.emplace_back(std::move(res.key), std::move(res.val));
+            }
+        }
+        return Tree<K, T>::fromSorted(entries);
+    }
+
+    // Reader is a thread's handle for lookups
+    class Reader {
+    protected:
+        OlcTree* tree;
+        EpochManager::Reader epoch;
+
+        friend class OlcTree;
+
+        explicit Reader(OlcTree& t) : tree(&t), epoch(t.epochs) {}
+
+    public:
+        std::optional<T> Get(KeyViewOf<K> search) {
+            Pin pin(epoch);
+            auto leaf = tree->findLeaf(search);
+            return leaf ? std::optional<T>(leaf->val) : std::nullopt;
+        }
+
+        std::optional<T> Get(const K& search) {
+            return Get(KeyViewOf<K>(search));
+        }
+
+        LongestPrefixResult<K, T> LongestPrefix(KeyViewOf<K> search) {
+            Pin pin(epoch);
+            auto last = tree->longestPrefixLeaf(search);
+            if (last) {
+                return {last->getKey(), last->val, true};
+            }
+            return {K{}, T{}, false};
+        }
+
+        LongestPrefixResult<K, T> LongestPrefix(const K& search) {
+            return LongestPrefix(KeyViewOf<K>(search));
+        }
+
+        // Pins the epoch until the view is destroyed; see View
+        View view() {
+            return View(epoch, *tree);
+        }
+    };
+
+    // Writer is a thread's handle for writes and lookups
+    class Writer : public Reader {
+    private:
+        WriterState* state;
+
+        friend class OlcTree;
+
+        explicit Writer(OlcTree& t) : Reader(t), state(t.claimWriter()) {}
+
+    public:
+        Writer(Writer&& other) noexcept : Reader(std::move(other)), state(other.state) {
+            other.state = nullptr;
+        }
+
+        ~Writer() {
+            if (state) {
+                state->claimed.store(false);
+            }
+        }
+
+        // Inserts or updates key, returning the previous value if any
+        std::optional<T> insert(KeyViewOf<K> key, const T& v) {
+            std::optional<T> old;
+            {
+                Pin pin(this->epoch);
+                old = this->tree->insert(*state, key, v);
+            }
+            this->tree->reclaim(*state);
+            return old;
+        }
+
+        std::optional<T> insert(const K& key, const T& v) {
+            return insert(KeyViewOf<K>(key), v);
+        }
+
+        // Deletes key, returning its value if it was present
+        std::optional<T> del(KeyViewOf<K> key) {
+            std::optional<T> old;
+            {
+                Pin pin(this->epoch);
+                old = this->tree->del(*state, key);
+            }
+            this->tree->reclaim(*state);
+            return old;
+        }
+
+        std::optional<T> del(const K& key) {
+            return del(KeyViewOf<K>(key));
+        }
+    };
+
+    Reader reader() {
+        return Reader(*this);
+    }
+
+    Writer writer() {
+        return Writer(*this);
+    }
+};
+
+#endif // OLC_TREE_H
@@ -0,0 +1,271 @@
+//
+// Created by Ashesh Vidyut on 22/03/25.
+//
+
+#ifndef SHARDED_TREE_H
+#define SHARDED_TREE_H
+
+#include "tree.hpp"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+// ShardedTree spreads its keys over independent Trees, each guarded by its
+// own reader-writer lock, so writes to different shards run in parallel.
+// Shards own contiguous key ranges rather than hash buckets: shard i holds
+// the keys in [splits[i-1], splits[i]). Key order therefore runs across
+// the shards in turn, and iteration, seekPrefix and GetAtIndex work over
+// the whole tree by visiting the shards in order.
+//
+// A single-key operation locks one shard. Operations that span shards lock
+// them one at a time in shard order, so each shard's part is consistent but
+// the whole is not a snapshot, except for GetAtIndex, which holds every
+// shard's read lock while it counts.
+template<typename K, typename T>
+class ShardedTree {
+private:
+    using C = typename K::value_type;
+
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        Tree<K, T> tree;
+    };
+
+    std::vector<K> splits;  // lowest key of shards 1..n-1
+    std::unique_ptr<Shard[]> shards;
+
+    // Keys compare as unsigned bytes, the order the trees iterate in
+    static bool less(KeyViewOf<K> a, KeyViewOf<K> b) {
+        int c = std::memcmp(a.data(), b.data(), std::min(a.size(), b.size()) * sizeof(C));
+        return c < 0 || (c == 0 && a.size() < b.size());
+    }
+
+    size_t shardOf(KeyViewOf<K> key) const {
+        auto it = std::upper_bound(splits.begin(), splits.end(), key, [](KeyViewOf<K> k, const K& split) {
+            return less(k, KeyViewOf<K>(split));
+        });
+        return it - splits.begin();
+    }
+
+    // One past the last shard that can hold a key starting with prefix
+    size_t shardsEndFor(KeyViewOf<K> prefix, size_t first) const {
+        size_t end = first + 1;
+        while (end < size() && hasPrefix(splits[end - 1], prefix)) {
+            end++;
+        }
+        return end;
+    }
+
+public:
+    // Splits the keys on their first byte into equal ranges. shards == 0
+    // uses one per hardware thread. Keys drawn from a narrow alphabet, such
+    // as hex UUIDs, should use splits taken from a sample instead.
+    explicit ShardedTree(size_t shardCount = 0) {
+        if (shardCount == 0) {
+            shardCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        shardCount = std::min<size_t>(shardCount, 256);
+        for (size_t i = 1; i < shardCount; i++) {
+            splits.push_back(K(1, static_cast<C>(256 * i / shardCount)));
+        }
+        shards.reset(new Shard[shardCount]);
+    }
+
+    // Uses the given split keys, which must be sorted and distinct; there is
+    // one more shard than there are splits
+    explicit ShardedTree(std::vector<K> splitKeys) : splits(std::move(splitKeys)) {
+        shards.reset(new Shard[splits.size() + 1]);
+    }
+
+    ShardedTree(const ShardedTree&) = delete;
+    ShardedTree& operator=(const ShardedTree&) = delete;
+
+    // Picks split keys that divide sample into shardCount ranges of about
+    // equal size
+    static std::vector<K> splitsFromSample(std::vector<K> sample, size_t shardCount) {
+        std::sort(sample.begin(), sample.end(), [](const K& a, const K& b) {
+            return less(KeyViewOf<K>(a), KeyViewOf<K>(b));
+        });
+        std::vector<K> result;
+        for (size_t i = 1; i < shardCount && !sample.empty(); i++) {
+            const K& split = sample[sample.size() * i / shardCount];
+            if (result.empty() || less(KeyViewOf<K>(result.back()), KeyViewOf<K>(split))) {
+                result.push_back(split);
+            }
+        }
+        return result;
+    }
+
+    size_t size() const {
+        return splits.size() + 1;
+    }
+
+    int len() const {
+        int n = 0;
+        for (size_t i = 0; i < size(); i++) {
+            std::shared_lock<std::shared_mutex> lock(shards[i].mutex);
+            n += shards[i].tree.len();
+        }
+        return n;
+    }
+
+    // Inserts or updates key, returning the previous value if any
+    std::optional<T> insert(const K& k, const T& v) {
+        auto& shard = shards[shardOf(KeyViewOf<K>(k))];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto [tree, oldVal, didUpdate] = shard.tree.insert(k, v);
+        return oldVal;
+    }
+
+    // Deletes key, returning its value if it was present
+    std::optional<T> del(const K& k) {
+        auto& shard = shards[shardOf(KeyViewOf<K>(k))];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto [tree, oldVal, found] = shard.tree.del(k);
+        return oldVal;
+    }
+
+    // Deletes every key starting with prefix and returns how many
+    int deletePrefix(const K& prefix) {
+        size_t first = shardOf(KeyViewOf<K>(prefix));
+        size_t end = shardsEndFor(KeyViewOf<K>(prefix), first);
+        int deleted = 0;
+        for (size_t i = first; i < end; i++) {
+            std::unique_lock<std::shared_mutex> lock(shards[i].mutex);
+            deleted += std::get<2>(shards[i].tree.deletePrefix(prefix));
+        }
+        return deleted;
+    }
+
+    std::optional<T> Get(KeyViewOf<K> search) const {
+        auto& shard = shards[shardOf(search)];
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        return shard.tree.Get(search);
+    }
+
+    std::optional<T> Get(const K& search) const {
+        return Get(KeyViewOf<K>(search));
+    }
+
+    // A prefix of search sorts before it, so it may live in an earlier
+    // shard. The prefixes below shard i's split are those no longer than
+    // what search shares with the split, short of the split itself, so a
+    // miss moves straight to the shard of the longest of them. Each shard
+    // read holds some prefix of search, and none is read twice.
+    LongestPrefixResult<K, T> LongestPrefix(KeyViewOf<K> search) const {
+        size_t i = shardOf(search);
+        while (true) {
+            {
+                std::shared_lock<std::shared_mutex> lock(shards[i].mutex);
+                auto result = shards[i].tree.LongestPrefix(search);
+                if (result.found) {
+                    return result;
+                }
+            }
+            if (i == 0) {
+                break;
+            }
+            KeyViewOf<K> split(splits[i - 1]);
+            size_t common = longestPrefix(search, split);
+            if (common == split.size()) {
+                if (common == 0) {
+                    break;
+                }
+                common--;
+            }
+            search = KeyViewOf<K>(search.data(), common);
+            i = shardOf(search);
+        }
+        return {K{}, T{}, false};
+    }
+
+    LongestPrefixResult<K, T> LongestPrefix(const K& search) const {
+        return LongestPrefix(KeyViewOf<K>(search));
+    }
+
+    // Returns the key and value at index in key order. Every shard is read
+    // locked, in shard order, so the count and the lookup agree.
+    std::tuple<K, T, bool> GetAtIndex(int index) const {
+        std::vector<std::shared_lock<std::shared_mutex>> locks;
+        locks.reserve(size());
+        for (size_t i = 0; i < size(); i++) {
+            locks.emplace_back(shards[i].mutex);
+        }
+        for (size_t i = 0; i < size() && index >= 0; i++) {
+            int n = shards[i].tree.len();
+            if (index < n) {
+                return shards[i].tree.GetAtIndex(index);
+            }
+            index -= n;
+        }
+        return {K{}, T{}, false};
+    }
+
+    // ShardIterator walks the shards in key order, each through its leaf
+    // list. It holds the read lock of the shard it is in, which keeps
+    // writers out of that shard until the iterator moves on or is destroyed,
+    // so a thread should be done with its iterator before it calls into the
+    // tree again.
+    class ShardIterator {
+    private:
+        const ShardedTree* owner;
+        size_t shard;
+        size_t end;
+        K prefix;
+        bool hasPrefixFilter = false;
+        std::shared_lock<std::shared_mutex> lock;
+        Iterator<K, T> it;
+
+        friend class ShardedTree;
+
+        explicit ShardIterator(const ShardedTree& t) : owner(&t), shard(0), end(t.size()), it(nullptr) {
+            open();
+        }
+
+        void open() {
+            if (shard >= end) {
+                lock = std::shared_lock<std::shared_mutex>();
+                it = Iterator<K, T>(nullptr);
+                return;
+            }
+            lock = std::shared_lock<std::shared_mutex>(owner->shards[shard].mutex);
+            it = owner->shards[shard].tree.iterator();
+            if (hasPrefixFilter) {
+                it.seekPrefix(prefix);
+            }
+        }
+
+    public:
+        // Restricts the iterator to keys starting with prefix
+        void seekPrefix(const K& p) {
+            prefix = p;
+            hasPrefixFilter = true;
+            lock = std::shared_lock<std::shared_mutex>();
+            shard = owner->shardOf(KeyViewOf<K>(prefix));
+            end = owner->shardsEndFor(KeyViewOf<K>(prefix), shard);
+            open();
+        }
+
+        // Returns the next element in order
+        IteratorResult<K, T> next() {
+            while (true) {
+                auto result = it.next();
+                if (result.found || shard >= end) {
+                    return result;
+                }
+                shard++;
+                open();
+            }
+        }
+    };
+
+    ShardIterator iterator() const {
+        return ShardIterator(*this);
+    }
+};
+
+#endif // SHARDED_TREE_H
@@ -7,12 +7,20 @@
 
 #include "node.hpp"
 #include "iterator.cpp"
+#include "value_codec.hpp"
 #include <memory>
 #include <vector>
-#include <functional>
 #include <optional>
 #include <tuple>
-#include <stack>
+#include <type_traits>
+#include <iterator>
+#include <limits>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 template<typename K>
 K concat(const K& a, const K& b);  // Implementation in node.hpp
@@ -27,41 +35,163 @@ class LeafNode;
 template<typename K, typename T>
 class PrefixIterator;
 
-// Simple object pool for reducing allocations
+// Block-based object pool. Objects are constructed a block at a time,
+// recycled through a free list, and destroyed together with the pool.
 template<typename T>
 class ObjectPool {
 private:
-    std::stack<std::unique_ptr<T>> pool;
-    std::function<std::unique_ptr<T>()> factory;
+    static constexpr size_t kBlockSize = 256;
+
+    std::vector<std::unique_ptr<T[]>> blocks;
+    size_t nextInBlock = kBlockSize;
+    std::vector<T*> freeList;
 
 public:
-    ObjectPool(std::function<std::unique_ptr<T>()> f) : factory(f) {}
-    
-    std::unique_ptr<T> acquire() {
-        if (pool.empty()) {
-            return factory();
+    ObjectPool() = default;
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    T* acquire() {
+        if (!freeList.empty()) {
+            auto obj = freeList.back();
+            freeList.pop_back();
+            return obj;
+        }
+        if (nextInBlock == kBlockSize) {
+            blocks.emplace_back(new T[kBlockSize]);
+            nextInBlock = 0;
         }
-        auto obj = std::move(pool.top());
-        pool.pop();
-        return obj;
+        return &blocks.back()[nextInBlock++];
     }
-    
-    void release(std::unique_ptr<T> obj) {
-        pool.push(std::move(obj));
+
+    // Resets the object so it holds no memory while on the free list
+    void release(T* obj) {
+        *obj = T();
+        freeList.push_back(obj);
+    }
+};
+
+// NodeArena owns every node and leaf of a tree. Nodes are carved out of
+// fixed-size blocks, recycled through free lists when they leave the tree,
+// and all released together when the last tree sharing the arena goes away.
+template<typename K, typename T>
+struct NodeArena {
+    ObjectPool<Node<K, T>> nodes;
+    ObjectPool<LeafNode<K, T>> leaves;
+    KeyBuffer<typename K::value_type> keys;
+
+    // Arenas of trees whose nodes were grafted into this one. Their blocks
+    // stay alive with this arena; released objects from them are recycled
+    // through this arena's free lists.
+    std::vector<std::shared_ptr<NodeArena<K, T>>> adopted;
+
+    // Ids handed out to tree versions, and the version whose leaves the
+    // nextLeaf/prevLeaf list links, or 0 once no tree holds that version.
+    // Only writes change the list; readers of any version load this to
+    // learn whether they may follow it.
+    uint64_t nextVersion = 1;
+    std::atomic<uint64_t> linkedVersion{0};
+
+    void adopt(std::shared_ptr<NodeArena<K, T>> other) {
+        keys.absorbCounts(other->keys);
+        adopted.push_back(std::move(other));
+    }
+
+    Node<K, T>* newNode() {
+        return nodes.acquire();
+    }
+
+    LeafNode<K, T>* newLeaf(KeyViewOf<K> k, const T& v) {
+        auto leaf = leaves.acquire();
+        leaf->key = keys.store(k);
+        leaf->val = v;
+        return leaf;
+    }
+
+    // Returns a node to the free list; its leaf and children are not touched
+    void releaseNode(Node<K, T>* n) {
+        n->prefix.release(keys);
+        nodes.release(n);
+    }
+
+    void releaseLeaf(LeafNode<K, T>* leaf) {
+        keys.release(leaf->key);
+        leaves.release(leaf);
+    }
+
+};
+
+// Nodes and leaves that a newer version of a tree replaced while an older
+// one could still reach them. Each bin holds the next newer one, so a bin,
+// and with it everything retired into it, is released once no version up
+// to and including its own is left.
+template<typename K, typename T>
+struct RetiredBin {
+    std::shared_ptr<NodeArena<K, T>> arena;
+    std::vector<Node<K, T>*> nodes;
+    std::vector<LeafNode<K, T>*> leaves;
+    std::shared_ptr<RetiredBin<K, T>> newer;
+
+    explicit RetiredBin(std::shared_ptr<NodeArena<K, T>> a) : arena(std::move(a)) {}
+    RetiredBin(const RetiredBin&) = delete;
+    RetiredBin& operator=(const RetiredBin&) = delete;
+
+    ~RetiredBin() {
+        for (auto n : nodes) {
+            arena->releaseNode(n);
+        }
+        for (auto leaf : leaves) {
+            arena->releaseLeaf(leaf);
+        }
+        // Release a run of newer bins without recursing once per version
+        auto next = std::move(newer);
+        while (next && next.use_count() == 1) {
+            auto after = std::move(next->newer);
+            next = std::move(after);
+        }
+    }
+};
+
+// TreeVersion is one state of a tree's contents. Copies of a Tree share a
+// version; writing through a tree whose version is shared, or that a newer
+// version was derived from, first derives a new version, and nodes are then
+// only changed in place if that version created them.
+template<typename K, typename T>
+struct TreeVersion {
+    uint64_t id = 0;
+    std::shared_ptr<RetiredBin<K, T>> bin;    // filled by versions derived from this one
+    std::weak_ptr<RetiredBin<K, T>> olderBin; // bin of the version this one was derived from
+    int successors = 0;                       // versions derived from this one
+    // Derived from a version that already had a successor. Nodes it replaces
+    // may still be in use on the other branch, so they are kept until the
+    // arena is released.
+    bool branched = false;
+
+    TreeVersion() = default;
+    TreeVersion(const TreeVersion&) = delete;
+    TreeVersion& operator=(const TreeVersion&) = delete;
+
+    // Once no tree holds the version, the leaf list linking it is free for
+    // the next write to claim
+    ~TreeVersion() {
+        if (bin) {
+            uint64_t linked = id;
+            bin->arena->linkedVersion.compare_exchange_strong(linked, 0);
+        }
     }
 };
 
 // Result structure for delete operations
 template<typename K, typename T>
 struct DeleteResult {
-    std::shared_ptr<Node<K, T>> node;
-    std::shared_ptr<LeafNode<K, T>> leaf;
+    Node<K, T>* node;
+    LeafNode<K, T>* leaf;
 };
 
 // Result structure for delete prefix operations
 template<typename K, typename T>
 struct DeletePrefixResult {
-    std::shared_ptr<Node<K, T>> node;
+    Node<K, T>* node;
     int numDeletions;
 };
 
@@ -69,19 +199,655 @@ struct DeletePrefixResult {
 template<typename K, typename T>
 class Tree {
 private:
-    std::shared_ptr<Node<K, T>> root;
+    // Copies of a tree share its arena, so nodes are reference counted once
+    // per tree rather than once per node
+    std::shared_ptr<NodeArena<K, T>> arena;
+    std::shared_ptr<TreeVersion<K, T>> version;
+    Node<K, T>* root;
     int size;
-    
-    // Object pools for reducing allocations
-    static ObjectPool<Node<K, T>> nodePool;
-    static ObjectPool<LeafNode<K, T>> leafPool;
+
+    using C = typename K::value_type;
+
+    // Lookups multiGet keeps in flight
+    static constexpr size_t kMultiGetWidth = 16;
+
+    // Start of a stream written by serialize
+    static constexpr char kStreamMagic[8] = {'R', 'A', 'D', 'I', 'X', 'S', 'T', 'R'};
+    static constexpr uint64_t kStreamVersion = 1;
 
     friend class Transaction;
 
+    Tree(std::shared_ptr<NodeArena<K, T>> a, std::shared_ptr<TreeVersion<K, T>> v, Node<K, T>* r, int s)
+        : arena(std::move(a)), version(std::move(v)), root(r), size(s) {}
+
+    static std::shared_ptr<TreeVersion<K, T>> newVersion(const std::shared_ptr<NodeArena<K, T>>& arena) {
+        auto v = std::make_shared<TreeVersion<K, T>>();
+        v->id = arena->nextVersion++;
+        v->bin = std::make_shared<RetiredBin<K, T>>(arena);
+        return v;
+    }
+
+    // True if the leaf list links this version's leaves, so iterators may
+    // follow it instead of stepping through the nodes
+    bool ownsLeafList() const {
+        return arena->linkedVersion.load(std::memory_order_acquire) == version->id;
+    }
+
+    // The leaf list is shared by every version of a tree but links the
+    // leaves of only one, and only a write to the one tree holding that
+    // version may change it, since any other holder may be iterating it.
+    // A list whose version no tree holds is relinked for this tree's, in
+    // one pass over its nodes, by the next write that has the tree to
+    // itself.
+    void claimLeafList() {
+        LeafNode<K, T>* last = nullptr;
+        std::vector<Node<K, T>*> stack{root};
+        while (!stack.empty()) {
+            auto n = stack.back();
+            stack.pop_back();
+            if (n->leaf) {
+                n->leaf->prevLeaf = last;
+                if (last) {
+                    last->nextLeaf = n->leaf;
+                }
+                last = n->leaf;
+            }
+            size_t mark = stack.size();
+            for (const auto& edge : n->edges) {
+                stack.push_back(edge.node);
+            }
+            std::reverse(stack.begin() + mark, stack.end());
+        }
+        if (last) {
+            last->nextLeaf = nullptr;
+        }
+        arena->linkedVersion.store(version->id, std::memory_order_release);
+    }
+
+    // Pairs are passed to loadSorted either directly or by pointer
+    template<typename P>
+    static const P& entryOf(const P& entry) {
+        return entry;
+    }
+
+    template<typename P>
+    static const P& entryOf(const P* entry) {
+        return *entry;
+    }
+
+    // Appends sorted (key, value) pairs to an empty tree, see fromSorted. The
+    // first skip elements of every key are left out of the tree's paths,
+    // which lets a subtree be built on its own and grafted in later.
+    template<typename It>
+    static void loadSorted(Tree<K, T>& tree, It begin, It end, size_t skip) {
+        struct OpenNode {
+            Node<K, T>* node;
+            size_t depth;  // length of the keys ending at this node
+        };
+        auto& arena = *tree.arena;
+        std::vector<OpenNode> path{{tree.root, 0}};
+        LeafNode<K, T>* lastLeaf = nullptr;
+
+        for (auto it = begin; it != end; ++it) {
+            const auto& entry = entryOf(*it);
+            KeyViewOf<K> key = KeyViewOf<K>(entry.first).substr(skip);
+            size_t common = 0;
+            if (lastLeaf) {
+                KeyViewOf<K> lastKey = lastLeaf->key.substr(skip);
+                common = longestPrefix(key, lastKey);
+                if (common == key.size() && common == lastKey.size()) {
+                    lastLeaf->val = entry.second;
+                    continue;
+                }
+            }
+
+            // Close the nodes the input has moved past
+            Node<K, T>* closed = nullptr;
+            while (path.back().depth > common) {
+                closed = path.back().node;
+                path.pop_back();
+                finishSortedNode(closed);
+            }
+
+            // The key branches off inside the last closed node's prefix
+            if (path.back().depth < common) {
+                size_t cut = common - path.back().depth;
+                auto splitNode = arena.newNode();
+                splitNode->prefix.assign(KeyViewOf<K>(closed->prefix.data(), cut), arena.keys);
+                closed->prefix.assign(KeyViewOf<K>(closed->prefix).substr(cut), arena.keys);
+                splitNode->addEdge({closed->prefix[0], closed});
+                path.back().node->replaceEdge({splitNode->prefix[0], splitNode});
+                path.push_back({splitNode, common});
+            }
+
+            auto leaf = arena.newLeaf(entry.first, entry.second);
+            if (lastLeaf) {
+                lastLeaf->nextLeaf = leaf;
+                leaf->prevLeaf = lastLeaf;
+            }
+            lastLeaf = leaf;
+            tree.size++;
+
+            if (key.size() == common) {
+                // Only a key with nothing past skip, which sorts first,
+                // ends on an open node (the root)
+                path.back().node->leaf = leaf;
+                continue;
+            }
+            auto newNode = arena.newNode();
+            newNode->prefix.assign(key.substr(common), arena.keys);
+            newNode->leaf = leaf;
+            path.back().node->addEdge({key[common], newNode});
+            path.push_back({newNode, key.size()});
+        }
+
+        while (!path.empty()) {
+            finishSortedNode(path.back().node);
+            path.pop_back();
+        }
+    }
+
+    // Node holding the keys that start with prefix, or nullptr if none do
+    const Node<K, T>* findPrefixNode(KeyViewOf<K> prefix) const {
+        const Node<K, T>* n = root;
+        while (!prefix.empty()) {
+            n = n->getEdge(prefix[0]);
+            if (!n) {
+                return nullptr;
+            }
+            size_t common = n->prefix.commonPrefix(prefix);
+            if (common == prefix.size()) {
+                break;
+            }
+            if (common < n->prefix.size()) {
+                return nullptr;
+            }
+            prefix = prefix.substr(common);
+        }
+        return n;
+    }
+
+    // Calls a walk's fn on a leaf and returns whether the walk goes on.
+    // Callables that return nothing never stop it.
+    template<typename F>
+    static bool visit(F& fn, KeyViewOf<K> key, const T& val) {
+        if constexpr (std::is_void_v<std::invoke_result_t<F&, KeyViewOf<K>, const T&>>) {
+            fn(key, val);
+            return true;
+        } else {
+            return fn(key, val);
+        }
+    }
+
+    template<typename F>
+    static bool visit(F& fn, const LeafNode<K, T>* leaf) {
+        return visit(fn, leaf->key, leaf->val);
+    }
+
+    // Visits count leaves under n in order, starting with the one at index
+    // first, by descending through the nodes as NodeIterator does, so it
+    // reads nothing but n's own version. The descent to first skips whole
+    // subtrees by their counts, as GetAtIndex does, and leaves the siblings
+    // still to come on the stack.
+    template<typename F>
+    static void walkNodes(const Node<K, T>* n, int first, int count, F& fn) {
+        using EdgeIterator = typename EdgeTable<Node<K, T>>::const_iterator;
+        std::vector<std::pair<EdgeIterator, EdgeIterator>> stack;
+        if (first >= n->leaves_in_subtree) {
+            return;
+        }
+        while (first > 0) {
+            if (n->leaf) {
+                first--;
+            }
+            auto it = n->edges.begin(), end = n->edges.end();
+            while (first >= (*it).node->leaves_in_subtree) {
+                first -= (*it).node->leaves_in_subtree;
+                ++it;
+            }
+            n = (*it).node;
+            stack.push_back({++it, end});
+        }
+        while (count > 0) {
+            if (n) {
+                if (n->leaf) {
+                    count--;
+                    if (!visit(fn, n->leaf)) {
+                        return;
+                    }
+                }
+                if (!n->edges.empty()) {
+                    stack.push_back({n->edges.begin(), n->edges.end()});
+                }
+                n = nullptr;
+                continue;
+            }
+            if (stack.empty()) {
+                return;
+            }
+            auto& top = stack.back();
+            if (top.first == top.second) {
+                stack.pop_back();
+                continue;
+            }
+            n = (*top.first).node;
+            ++top.first;
+        }
+    }
+
+    // Runs job(0) .. job(jobs - 1) on up to threads threads, the calling
+    // one included
+    template<typename Job>
+    static void runWorkers(unsigned threads, size_t jobs, const Job& job) {
+        std::atomic<size_t> next{0};
+        auto work = [&]() {
+            for (size_t i = next++; i < jobs; i = next++) {
+                job(i);
+            }
+        };
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < std::min<size_t>(threads, jobs); t++) {
+            workers.emplace_back(work);
+        }
+        work();
+        for (auto& w : workers) {
+            w.join();
+        }
+    }
+
+    // Splits the keys of n's subtree into chunks of equal count, at most
+    // one per thread and none under minChunk keys, and calls
+    // chunk(c, first, count) for each on a worker, where first is the
+    // index of the chunk's first key under n. Returns the number of chunks.
+    template<typename Chunk>
+    static size_t forEachChunk(const Node<K, T>* n, unsigned threads, const Chunk& chunk) {
+        constexpr int minChunk = 4096;
+        int total = n->leaves_in_subtree;
+        size_t chunks = std::max<size_t>(1, std::min<size_t>(threads, total / minChunk));
+        runWorkers(threads, chunks, [&](size_t c) {
+            int from = static_cast<int>(int64_t(total) * c / chunks);
+            int to = static_cast<int>(int64_t(total) * (c + 1) / chunks);
+            chunk(c, from, to - from);
+        });
+        return chunks;
+    }
+
+    // Each chunk walks its own stretch of nodes; returning false from fn
+    // stops every chunk at its next key
+    template<typename F>
+    static void parallelForEachFrom(const Node<K, T>* n, F& fn, unsigned threads) {
+        std::atomic<bool> stopped{false};
+        forEachChunk(n, workerCount(threads), [&](size_t, int first, int count) {
+            auto step = [&](KeyViewOf<K> key, const T& val) {
+                if (stopped.load(std::memory_order_relaxed)) {
+                    return false;
+                }
+                if (!visit(fn, key, val)) {
+                    stopped.store(true, std::memory_order_relaxed);
+                    return false;
+                }
+                return true;
+            };
+            walkNodes(n, first, count, step);
+        });
+    }
+
+    template<typename R, typename F, typename Combine>
+    static R parallelReduceFrom(const Node<K, T>* n, R identity, F& fold, Combine& combine, unsigned threads) {
+        threads = workerCount(threads);
+        std::vector<R> partial(threads, identity);
+        size_t chunks = forEachChunk(n, threads, [&](size_t c, int first, int count) {
+            R acc = identity;
+            auto step = [&](KeyViewOf<K> key, const T& val) {
+                acc = fold(std::move(acc), key, val);
+            };
+            walkNodes(n, first, count, step);
+            partial[c] = std::move(acc);
+        });
+        R result = std::move(partial[0]);
+        for (size_t c = 1; c < chunks; c++) {
+            result = combine(std::move(result), std::move(partial[c]));
+        }
+        return result;
+    }
+
+    static unsigned workerCount(unsigned threads) {
+        return threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Fills in min/max leaves and the leaf count of a node built by
+    // fromSorted, whose children are all complete
+    static void finishSortedNode(Node<K, T>* n) {
+        n->updateMinMaxLeaves();
+        n->leaves_in_subtree = n->leaf ? 1 : 0;
+        for (const auto& edge : n->edges) {
+            n->leaves_in_subtree += edge.node->leaves_in_subtree;
+        }
+    }
+
 public:
-    Tree() : root(std::make_shared<Node<K, T>>()), size(0) {}
+    Tree() : arena(std::make_shared<NodeArena<K, T>>()), version(newVersion(arena)), root(arena->newNode()), size(0) {
+        arena->linkedVersion.store(version->id, std::memory_order_release);
+    }
+
+    // fromSorted builds a tree from (key, value) pairs in ascending key order
+    // in a single pass. Nodes are created along the rightmost path of the
+    // tree and get their min/max leaves and counts once, when the input moves
+    // past them; leaves are chained in input order. A key repeated in the
+    // input keeps its last value, like insert. Input that is not sorted is
+    // loaded with insert instead.
+    template<typename It>
+    static Tree<K, T> fromSorted(It begin, It end) {
+        Tree<K, T> tree;
+        auto byKey = [](const auto& a, const auto& b) { return a.first < b.first; };
+        if (!std::is_sorted(begin, end, byKey)) {
+            for (auto it = begin; it != end; ++it) {
+                tree.insert(it->first, it->second);
+            }
+            return tree;
+        }
 
-    std::shared_ptr<Node<K, T>> getRoot() const {
+        loadSorted(tree, begin, end, 0);
+        return tree;
+    }
+
+    template<typename Container>
+    static Tree<K, T> fromSorted(const Container& sorted) {
+        return fromSorted(sorted.begin(), sorted.end());
+    }
+
+    // fromUnsorted builds a tree from unsorted (key, value) pairs on several
+    // threads. The pairs are split into partitions by their first
+    // partitionBytes elements; each partition is sorted and bulk loaded into
+    // its own subtree on a worker, and the subtrees are then grafted under a
+    // small top tree holding the partition prefixes and any shorter keys.
+    // Only the nodes of the top tree have their links recomputed, which also
+    // joins the leaf chains at the partition boundaries. Raise partitionBytes
+    // when most keys share their first byte. A key repeated in the input keeps
+    // its last value, like insert. threads == 0 uses one per hardware thread.
+    static Tree<K, T> fromUnsorted(const std::vector<std::pair<K, T>>& entries,
+                                   unsigned threads = 0, size_t partitionBytes = 1) {
+        using Entry = std::pair<K, T>;
+        using Bucket = std::vector<const Entry*>;
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        partitionBytes = std::max<size_t>(partitionBytes, 1);
+
+        // Scatter contiguous chunks of the input into per-chunk partitions,
+        // so each partition can later be reassembled in input order
+        struct Scatter {
+            std::unordered_map<std::string, Bucket> partitions;
+            Bucket shortKeys;
+        };
+        size_t chunks = std::max<size_t>(1, std::min<size_t>(threads, entries.size() / 4096));
+        std::vector<Scatter> scattered(chunks);
+        runWorkers(threads, chunks, [&](size_t c) {
+            size_t from = entries.size() * c / chunks;
+            size_t to = entries.size() * (c + 1) / chunks;
+            auto& out = scattered[c];
+            for (size_t i = from; i < to; i++) {
+                const auto& key = entries[i].first;
+                if (key.size() < partitionBytes) {
+                    out.shortKeys.push_back(&entries[i]);
+                    continue;
+                }
+                std::string id(reinterpret_cast<const char*>(key.data()), partitionBytes * sizeof(C));
+                out.partitions[id].push_back(&entries[i]);
+            }
+        });
+
+        struct Partition {
+            std::string id;
+            std::vector<Bucket*> pieces;
+            size_t count = 0;
+            Tree<K, T> subtree;
+        };
+        std::vector<Partition> partitions;
+        std::unordered_map<std::string, size_t> partitionIndex;
+        for (auto& chunk : scattered) {
+            for (auto& [id, bucket] : chunk.partitions) {
+                auto [pos, added] = partitionIndex.emplace(id, partitions.size());
+                if (added) {
+                    partitions.push_back(Partition{id, {}, 0, Tree<K, T>()});
+                }
+                partitions[pos->second].pieces.push_back(&bucket);
+                partitions[pos->second].count += bucket.size();
+            }
+        }
+
+        // Build the largest partitions first to keep the workers balanced
+        std::vector<size_t> order(partitions.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return partitions[a].count > partitions[b].count;
+        });
+        auto byKey = [](const Entry* a, const Entry* b) { return a->first < b->first; };
+        runWorkers(threads, order.size(), [&](size_t i) {
+            auto& part = partitions[order[i]];
+            Bucket sorted;
+            sorted.reserve(part.count);
+            for (auto piece : part.pieces) {
+                sorted.insert(sorted.end(), piece->begin(), piece->end());
+            }
+            std::stable_sort(sorted.begin(), sorted.end(), byKey);
+            loadSorted(part.subtree, sorted.begin(), sorted.end(), partitionBytes);
+        });
+
+        // The top tree holds the short keys and a placeholder leaf at each
+        // partition prefix, which is where that partition's subtree goes
+        Bucket shortKeys;
+        for (auto& chunk : scattered) {
+            shortKeys.insert(shortKeys.end(), chunk.shortKeys.begin(), chunk.shortKeys.end());
+        }
+        std::stable_sort(shortKeys.begin(), shortKeys.end(), byKey);
+        std::vector<Entry> placeholders;
+        placeholders.reserve(partitions.size());
+        for (const auto& part : partitions) {
+            auto first = part.pieces.front()->front();
+            placeholders.push_back({K(first->first.begin(), first->first.begin() + partitionBytes), T{}});
+        }
+        Bucket top;
+        top.reserve(shortKeys.size() + placeholders.size());
+        for (const auto& placeholder : placeholders) {
+            top.push_back(&placeholder);
+        }
+        top.insert(top.end(), shortKeys.begin(), shortKeys.end());
+        std::stable_sort(top.begin(), top.end(), byKey);
+
+        Tree<K, T> tree;
+        loadSorted(tree, top.begin(), top.end(), 0);
+        auto& arena = *tree.arena;
+        Transaction txn(tree, false);
+        std::unordered_set<Node<K, T>*> grafted;
+        for (size_t i = 0; i < partitions.size(); i++) {
+            auto& part = partitions[i];
+            // The partition prefix is a key of the top tree, so it ends
+            // exactly at a node
+            Node<K, T>* n = tree.root;
+            KeyViewOf<K> search(placeholders[i].first);
+            while (!search.empty()) {
+                n = n->getEdge(search[0]);
+                search = search.substr(n->prefix.size());
+            }
+            arena.releaseLeaf(n->leaf);
+            auto subRoot = part.subtree.root;
+            n->leaf = subRoot->leaf;
+            n->edges.swap(subRoot->edges);
+            subRoot->leaf = nullptr;
+            if (!n->leaf && n->edges.size() == 1) {
+                txn.mergeChild(n);
+            }
+            grafted.insert(n);
+            tree.size += part.subtree.size - 1;
+            arena.adopt(part.subtree.arena);
+        }
+
+        // Recompute links bottom-up over the top tree only
+        std::vector<std::pair<Node<K, T>*, bool>> stack{{tree.root, false}};
+        while (!stack.empty()) {
+            auto [n, childrenDone] = stack.back();
+            if (childrenDone || grafted.count(n)) {
+                stack.pop_back();
+                n->computeLinks();
+                continue;
+            }
+            stack.back().second = true;
+            for (const auto& edge : n->edges) {
+                stack.push_back({edge.node, false});
+            }
+        }
+        return tree;
+    }
+
+    // serialize writes the tree to out as a stream of node records in
+    // pre-order, children in label order, which is also key order:
+    //
+    //   "RADIXSTR" varint(version) varint(sizeof(C)) varint(keyCount)
+    //   per node: varint(prefixLen) prefix varint(edgeCount * 2 + hasLeaf)
+    //             [varint(valueLen) value]
+    //   uint64_t checksum of everything before it
+    //
+    // Keys are not stored: a leaf's key is the prefixes on its path, so the
+    // stream is as prefix compressed as the tree. Records are written as the
+    // walk reaches them, through a fixed buffer, so serializing needs no
+    // memory beyond the walk's stack. Returns false if out failed.
+    bool serialize(std::ostream& out) const {
+        static_assert(sizeof(C) == 1, "serialized trees hold byte keys");
+        StreamWriter w(out);
+        w.put(kStreamMagic, sizeof(kStreamMagic));
+        w.putVarint(kStreamVersion);
+        w.putVarint(sizeof(C));
+        w.putVarint(size);
+
+        std::string value;
+        std::vector<const Node<K, T>*> stack{root};
+        std::vector<const Node<K, T>*> children;
+        while (!stack.empty()) {
+            auto n = stack.back();
+            stack.pop_back();
+            KeyViewOf<K> prefix(n->prefix);
+            w.putVarint(prefix.size());
+            w.put(prefix.data(), prefix.size() * sizeof(C));
+            w.putVarint(n->edges.size() * 2 + (n->leaf ? 1 : 0));
+            if (n->leaf) {
+                value.clear();
+                ValueCodec<T>::encode(n->leaf->val, value);
+                w.putVarint(value.size());
+                w.put(value.data(), value.size());
+            }
+            children.clear();
+            for (const auto& edge : n->edges) {
+                children.push_back(edge.node);
+            }
+            stack.insert(stack.end(), children.rbegin(), children.rend());
+        }
+
+        uint64_t sum = w.checksum();
+        w.put(&sum, sizeof(sum));
+        return w.flush();
+    }
+
+    // deserialize reads a tree written by serialize. Nodes are rebuilt
+    // directly from the records, the way fromSorted builds them: a node's
+    // min/max leaves and count are filled in once its last child is read,
+    // and leaves are chained in the order they arrive. Returns nothing if
+    // the stream is truncated, malformed or fails its checksum.
+    static std::optional<Tree<K, T>> deserialize(std::istream& in) {
+        StreamReader r(in);
+        char magic[sizeof(kStreamMagic)];
+        uint64_t version, charSize, keyCount;
+        if (!r.get(magic, sizeof(magic)) || std::memcmp(magic, kStreamMagic, sizeof(magic)) != 0 ||
+            !r.getVarint(version) || version != kStreamVersion ||
+            !r.getVarint(charSize) || charSize != sizeof(C) || !r.getVarint(keyCount)) {
+            return std::nullopt;
+        }
+
+        struct OpenNode {
+            Node<K, T>* node;
+            size_t depth;          // length of the keys ending at this node
+            uint64_t childrenLeft;
+            int lastLabel;         // children must arrive in label order
+        };
+        Tree<K, T> tree;
+        auto& arena = *tree.arena;
+        std::vector<OpenNode> path;
+        std::vector<C> key;
+        std::string value;
+        LeafNode<K, T>* lastLeaf = nullptr;
+
+        // Reads one record into n, whose parent's keys have length depth
+        auto readNode = [&](Node<K, T>* n, size_t depth) {
+            uint64_t prefixLen, header;
+            if (!r.getVarint(prefixLen) || prefixLen > std::numeric_limits<uint32_t>::max()) {
+                return false;
+            }
+            key.resize(depth);
+            if (!r.append(key, prefixLen) || !r.getVarint(header) || header >> 1 > 256) {
+                return false;
+            }
+            if (prefixLen > 0) {
+                n->prefix.assign(KeyViewOf<K>(key.data() + depth, prefixLen), arena.keys);
+            }
+            if (header & 1) {
+                uint64_t valueLen;
+                if (!r.getVarint(valueLen) || valueLen > std::numeric_limits<uint32_t>::max()) {
+                    return false;
+                }
+                value.clear();
+                T v{};
+                if (!r.append(value, valueLen) || !ValueCodec<T>::decode(value.data(), valueLen, v)) {
+                    return false;
+                }
+                auto leaf = arena.newLeaf(KeyViewOf<K>(key.data(), key.size()), v);
+                if (lastLeaf) {
+                    lastLeaf->nextLeaf = leaf;
+                    leaf->prevLeaf = lastLeaf;
+                }
+                lastLeaf = leaf;
+                n->leaf = leaf;
+                tree.size++;
+            }
+            path.push_back({n, key.size(), header >> 1, -1});
+            return true;
+        };
+
+        if (!readNode(tree.root, 0) || !tree.root->prefix.empty()) {
+            return std::nullopt;
+        }
+        while (true) {
+            while (!path.empty() && path.back().childrenLeft == 0) {
+                finishSortedNode(path.back().node);
+                path.pop_back();
+            }
+            if (path.empty()) {
+                break;
+            }
+            auto& parent = path.back();
+            parent.childrenLeft--;
+            auto parentNode = parent.node;
+            int lastLabel = parent.lastLabel;
+            auto child = arena.newNode();
+            if (!readNode(child, parent.depth) || child->prefix.empty() ||
+                static_cast<uint8_t>(child->prefix[0]) <= lastLabel) {
+                return std::nullopt;
+            }
+            // readNode pushed the child, so the parent is one below the top
+            path[path.size() - 2].lastLabel = static_cast<uint8_t>(child->prefix[0]);
+            parentNode->addEdge({child->prefix[0], child});
+        }
+
+        uint64_t expected = r.checksum();
+        uint64_t sum;
+        if (!r.get(&sum, sizeof(sum)) || sum != expected || static_cast<uint64_t>(tree.size) != keyCount) {
+            return std::nullopt;
+        }
+        return tree;
+    }
+
+    Node<K, T>* getRoot() const {
         return root;
     }
 
@@ -93,386 +859,870 @@ public:
         return root->leaves_in_subtree;
     }
 
-    // Transaction class for atomic operations
+    // Transaction applies a batch of writes to a tree. Writes copy the path
+    // from the root to the changed node: a node is only changed in place if
+    // this transaction's version created it, or if no other version can
+    // reach it, so every Tree value taken earlier keeps reading the nodes it
+    // had. A transaction from txn() is isolated: the tree is left alone until
+    // commit(), and an uncommitted transaction discards its nodes when it is
+    // destroyed.
     class Transaction {
     protected:
-        std::shared_ptr<Node<K, T>> root;
+        Node<K, T>* root;
         int size;
         Tree<K, T>& tree;
+        NodeArena<K, T>& arena;
 
         friend class Tree;
 
+        // A change to the leaf list, applied at once or, in an isolated
+        // transaction, replayed in order at commit
+        struct LeafLink {
+            enum Op { kLink, kUnlink, kReplace } op;
+            LeafNode<K, T>* leaf;   // leaf linked, first leaf unlinked, or old leaf replaced
+            LeafNode<K, T>* other;  // predecessor, last leaf unlinked, or new leaf
+        };
+        enum LinkMode { kImmediate, kDeferred, kDetached };
+
+        Node<K, T>* baseRoot;
+        std::shared_ptr<TreeVersion<K, T>> base;     // version the transaction started from
+        std::shared_ptr<TreeVersion<K, T>> version;  // version it writes; base when writing in place
+        std::shared_ptr<RetiredBin<K, T>> retired;   // where replaced nodes wait for older versions
+        size_t retiredNodesMark = 0;
+        size_t retiredLeavesMark = 0;
+        bool exclusive;  // no other version can reach any node of the tree
+        bool committed = false;
+        LinkMode linkMode;
+        std::vector<LeafLink> pendingLinks;
+        std::vector<LeafNode<K, T>*> deadLeaves;  // unlinked leaves kept until the links are replayed
+
+        // Creates a node holding a single new leaf under the given prefix
+        Node<K, T>* newLeafNode(KeyViewOf<K> k, const T& v, KeyViewOf<K> prefix) {
+            auto leaf = newLeaf(k, v);
+            auto newNode = this->newNode();
+            newNode->leaf = leaf;
+            newNode->minLeaf = leaf;
+            newNode->maxLeaf = leaf;
+            newNode->prefix.assign(prefix, arena.keys);
+            newNode->leaves_in_subtree = 1;
+            return newNode;
+        }
+
+        Node<K, T>* newNode() {
+            auto n = arena.newNode();
+            n->owner = version->id;
+            return n;
+        }
+
+        LeafNode<K, T>* newLeaf(KeyViewOf<K> k, const T& v) {
+            auto leaf = arena.newLeaf(k, v);
+            leaf->owner = version->id;
+            return leaf;
+        }
+
+        // True if the node or leaf may be changed in place
+        template<typename N>
+        bool owns(const N* p) const {
+            return exclusive || p->owner == version->id;
+        }
+
+        // Returns n if it may be changed in place, otherwise a copy of it
+        // that may, retiring n
+        Node<K, T>* writable(Node<K, T>* n) {
+            if (owns(n)) {
+                return n;
+            }
+            auto copy = newNode();
+            copy->leaf = n->leaf;
+            copy->minLeaf = n->minLeaf;
+            copy->maxLeaf = n->maxLeaf;
+            copy->prefix.assign(KeyViewOf<K>(n->prefix), arena.keys);
+            copy->edges = n->edges;
+            copy->leaves_in_subtree = n->leaves_in_subtree;
+            retire(n);
+            return copy;
+        }
+
+        // Releases a node that left the tree, or hands it to the older
+        // versions that can still reach it
+        void retire(Node<K, T>* n) {
+            if (owns(n)) {
+                arena.releaseNode(n);
+            } else if (retired) {
+                retired->nodes.push_back(n);
+            }
+        }
+
+        void retireLeaf(LeafNode<K, T>* leaf) {
+            if (!owns(leaf)) {
+                if (retired) {
+                    retired->leaves.push_back(leaf);
+                }
+            } else if (linkMode == kDeferred) {
+                deadLeaves.push_back(leaf);
+            } else {
+                arena.releaseLeaf(leaf);
+            }
+        }
+
+        void retireSubtree(Node<K, T>* n) {
+            std::vector<Node<K, T>*> stack{n};
+            while (!stack.empty()) {
+                auto cur = stack.back();
+                stack.pop_back();
+                for (const auto& edge : cur->edges) {
+                    stack.push_back(edge.node);
+                }
+                if (cur->leaf) {
+                    retireLeaf(cur->leaf);
+                }
+                retire(cur);
+            }
+        }
+
+        // Derives the version this transaction writes from base
+        std::shared_ptr<TreeVersion<K, T>> derive() {
+            auto v = newVersion(tree.arena);
+            v->branched = base->branched || base->successors > 0;
+            if (!v->branched) {
+                base->bin->newer = v->bin;
+                v->olderBin = base->bin;
+            }
+            base->successors++;
+            return v;
+        }
+
+        // Releases what an uncommitted transaction created and takes back
+        // what it retired from base
+        void discard() {
+            base->successors--;
+            if (!version->branched) {
+                base->bin->newer.reset();
+                base->bin->nodes.resize(retiredNodesMark);
+                base->bin->leaves.resize(retiredLeavesMark);
+            }
+            for (auto leaf : deadLeaves) {
+                arena.releaseLeaf(leaf);
+            }
+            // Only nodes created here reach nodes created here
+            std::vector<Node<K, T>*> stack;
+            if (owns(root)) {
+                stack.push_back(root);
+            }
+            while (!stack.empty()) {
+                auto cur = stack.back();
+                stack.pop_back();
+                for (const auto& edge : cur->edges) {
+                    if (owns(edge.node)) {
+                        stack.push_back(edge.node);
+                    }
+                }
+                if (cur->leaf && owns(cur->leaf)) {
+                    arena.releaseLeaf(cur->leaf);
+                }
+                arena.releaseNode(cur);
+            }
+        }
+
+        static void applyLink(const LeafLink& l, LeafNode<K, T>*& head) {
+            switch (l.op) {
+                case LeafLink::kLink: {
+                    auto succ = l.other ? l.other->nextLeaf : head;
+                    l.leaf->prevLeaf = l.other;
+                    l.leaf->nextLeaf = succ;
+                    if (l.other) {
+                        l.other->nextLeaf = l.leaf;
+                    } else {
+                        head = l.leaf;
+                    }
+                    if (succ) {
+                        succ->prevLeaf = l.leaf;
+                    }
+                    break;
+                }
+                case LeafLink::kUnlink:
+                    if (l.leaf->prevLeaf) {
+                        l.leaf->prevLeaf->nextLeaf = l.other->nextLeaf;
+                    } else {
+                        head = l.other->nextLeaf;
+                    }
+                    if (l.other->nextLeaf) {
+                        l.other->nextLeaf->prevLeaf = l.leaf->prevLeaf;
+                    }
+                    break;
+                case LeafLink::kReplace:
+                    l.other->prevLeaf = l.leaf->prevLeaf;
+                    l.other->nextLeaf = l.leaf->nextLeaf;
+                    if (l.leaf->prevLeaf) {
+                        l.leaf->prevLeaf->nextLeaf = l.other;
+                    } else {
+                        head = l.other;
+                    }
+                    if (l.leaf->nextLeaf) {
+                        l.leaf->nextLeaf->prevLeaf = l.other;
+                    }
+                    break;
+            }
+        }
+
+        void relink(const LeafLink& l) {
+            if (linkMode == kImmediate) {
+                // The root is only updated once the write is done, so its
+                // minLeaf is still the head of the list
+                auto head = root->minLeaf;
+                applyLink(l, head);
+            } else if (linkMode == kDeferred) {
+                pendingLinks.push_back(l);
+            }
+        }
+
+        // Hands the leaf list to the new version. Deferred changes are only
+        // applied when the tree is about to drop base and no other tree
+        // has taken a copy of it since the transaction started; otherwise
+        // the list keeps linking base and the new version is iterated
+        // through its nodes.
+        void finishLinks(bool publishing) {
+            if (linkMode == kImmediate) {
+                arena.linkedVersion.store(version->id, std::memory_order_release);
+            } else if (linkMode == kDeferred && publishing && base.use_count() == 2 &&
+                       arena.linkedVersion.load(std::memory_order_relaxed) == base->id) {
+                auto head = baseRoot->minLeaf;
+                for (const auto& l : pendingLinks) {
+                    applyLink(l, head);
+                }
+                arena.linkedVersion.store(version->id, std::memory_order_release);
+            }
+            for (auto leaf : deadLeaves) {
+                arena.releaseLeaf(leaf);
+            }
+            pendingLinks.clear();
+            deadLeaves.clear();
+        }
+
+        // Makes the transaction's version the tree's
+        void publish() {
+            finishLinks(true);
+            committed = true;
+            tree.root = root;
+            tree.size = size;
+            if (tree.version != version) {
+                tree.version = version;
+            }
+        }
+
     public:
-        Transaction(Tree<K, T>& t) : root(t.root), size(t.size), tree(t) {}
+        // An isolated transaction always writes a new version. Otherwise the
+        // tree's version is written in place when no other Tree holds it.
+        explicit Transaction(Tree<K, T>& t, bool isolated = true)
+            : root(t.root), size(t.size), tree(t), arena(*t.arena), baseRoot(t.root) {
+            bool heldElsewhere = t.version.use_count() > 1;
+            bool shared = isolated || heldElsewhere || t.version->successors > 0;
+            base = t.version;
+            version = shared ? derive() : base;
+            if (!version->branched) {
+                retired = version->olderBin.lock();
+            }
+            exclusive = !version->branched && !retired;
+            if (retired) {
+                retiredNodesMark = retired->nodes.size();
+                retiredLeavesMark = retired->leaves.size();
+            }
+            // The list may only change under a tree that is the sole holder
+            // of the version it links; another holder may be iterating it
+            uint64_t linked = arena.linkedVersion.load(std::memory_order_relaxed);
+            if (linked == 0 && !heldElsewhere) {
+                t.claimLeafList();
+                linked = base->id;
+            }
+            if (linked != base->id || heldElsewhere) {
+                linkMode = kDetached;
+            } else {
+                linkMode = isolated ? kDeferred : kImmediate;
+            }
+        }
 
-        std::tuple<std::shared_ptr<Node<K, T>>, std::optional<T>, bool> insert(
-            std::shared_ptr<Node<K, T>> n,
-            const K& k,
-            const K& search,
-            const T& v) {
+        Transaction(const Transaction&) = delete;
+        Transaction& operator=(const Transaction&) = delete;
+
+        ~Transaction() {
+            if (!committed && version != base) {
+                discard();
+            }
+        }
+
+        // Splices a new leaf into the leaf list after pred, or in front of
+        // every other leaf when pred is null
+        void linkLeaf(LeafNode<K, T>* leaf, LeafNode<K, T>* pred) {
+            relink({LeafLink::kLink, leaf, pred});
+        }
+
+        // Removes the leaves first..last, which are adjacent in the leaf
+        // list, from it
+        void unlinkLeaves(LeafNode<K, T>* first, LeafNode<K, T>* last) {
+            relink({LeafLink::kUnlink, first, last});
+        }
+
+        // Adjusts a node on the path of an insert or delete whose subtree
+        // gained or lost delta leaves. Only the first and last child are
+        // looked at, so this is O(1) whatever the fan-out.
+        void adjustPath(Node<K, T>* n, int delta) {
+            n->leaves_in_subtree += delta;
+            n->updateMinMaxLeaves();
+        }
+
+        // Inserts or updates k, returning the old value and whether there
+        // was one
+        std::tuple<std::optional<T>, bool> insert(KeyViewOf<K> k, const T& v) {
+            auto [newRoot, oldVal, didUpdate] = insert(root, k, k, v);
+            root = newRoot;
+            if (!didUpdate) {
+                size++;
+            }
+            return {oldVal, didUpdate};
+        }
+
+        // Inserts (key, value) pairs given in ascending key order, or
+        // pointers to them, and returns how many keys were new. The path to
+        // the previous key stays open on a stack and each key resumes from
+        // the deepest node it shares with the previous one, so shared upper
+        // nodes are walked and copied once per batch rather than once per
+        // key. Min/max leaves and leaf counts of the open nodes are settled
+        // when the input moves past them instead of on every insert.
+        template<typename It>
+        int insertSorted(It begin, It end) {
+            struct OpenNode {
+                Node<K, T>* node;
+                size_t depth;  // length of the keys ending at this node
+                int added;     // leaves added below it not yet counted
+            };
+            root = writable(root);
+            std::vector<OpenNode> path{{root, 0, 0}};
+            auto close = [&]() {
+                auto open = path.back();
+                path.pop_back();
+                open.node->leaves_in_subtree += open.added;
+                open.node->updateMinMaxLeaves();
+                if (!path.empty()) {
+                    path.back().added += open.added;
+                }
+            };
+
+            int inserted = 0;
+            KeyViewOf<K> lastKey;
+            LeafNode<K, T>* pred = nullptr;
+            for (auto it = begin; it != end; ++it) {
+                const auto& entry = entryOf(*it);
+                KeyViewOf<K> k(entry.first);
+                const T& v = entry.second;
+
+                // Close the nodes that lie past where k leaves the last key
+                if (it != begin) {
+                    size_t common = longestPrefix(k, lastKey);
+                    while (path.back().depth > common) {
+                        close();
+                    }
+                }
+                lastKey = k;
+
+                KeyViewOf<K> search = k.substr(path.back().depth);
+                while (true) {
+                    Node<K, T>* n = path.back().node;
+                    size_t depth = path.back().depth;
+
+                    // The key ends at an open node
+                    if (search.empty()) {
+                        if (!n->leaf) {
+                            n->leaf = newLeaf(k, v);
+                            linkLeaf(n->leaf, pred);
+                            path.back().added++;
+                            inserted++;
+                        } else if (owns(n->leaf)) {
+                            n->leaf->val = v;
+                        } else {
+                            auto old = n->leaf;
+                            n->leaf = newLeaf(k, v);
+                            relink({LeafLink::kReplace, old, n->leaf});
+                            retireLeaf(old);
+                        }
+                        pred = n->leaf;
+                        break;
+                    }
+
+                    // Same refinement as insert; the children read here are
+                    // all closed, so their max leaves are current
+                    auto label = static_cast<uint8_t>(search[0]);
+                    if (n->leaf) {
+                        pred = n->leaf;
+                    }
+                    if (auto below = n->edges.before(label)) {
+                        pred = below->maxLeaf;
+                    }
+
+                    auto child = n->getEdge(search[0]);
+                    if (!child) {
+                        auto leafNode = newLeafNode(k, v, search);
+                        linkLeaf(leafNode->leaf, pred);
+                        n->addEdge({search[0], leafNode});
+                        path.back().added++;
+                        path.push_back({leafNode, k.size(), 0});
+                        pred = leafNode->leaf;
+                        inserted++;
+                        break;
+                    }
+
+                    size_t commonPrefix = longestPrefix(search, child->prefix);
+                    if (commonPrefix == child->prefix.size()) {
+                        child = writable(child);
+                        n->edges.replace(label, child);
+                        path.push_back({child, depth + commonPrefix, 0});
+                        search = search.substr(commonPrefix);
+                        continue;
+                    }
+
+                    // Split the child where k leaves its prefix
+                    auto splitNode = newNode();
+                    splitNode->prefix.assign(KeyViewOf<K>(search.data(), commonPrefix), arena.keys);
+                    auto childLabel = child->prefix[commonPrefix];
+                    child = writable(child);
+                    child->prefix.assign(KeyViewOf<K>(child->prefix).substr(commonPrefix), arena.keys);
+                    splitNode->addEdge({childLabel, child});
+                    splitNode->leaves_in_subtree = child->leaves_in_subtree;
+                    n->replaceEdge({search[0], splitNode});
+                    path.push_back({splitNode, depth + commonPrefix, 1});
+                    inserted++;
+
+                    KeyViewOf<K> remaining = search.substr(commonPrefix);
+                    if (remaining.empty()) {
+                        splitNode->leaf = newLeaf(k, v);
+                        linkLeaf(splitNode->leaf, pred);
+                        pred = splitNode->leaf;
+                        break;
+                    }
+                    if (static_cast<uint8_t>(remaining[0]) > static_cast<uint8_t>(childLabel)) {
+                        pred = child->maxLeaf;
+                    }
+                    auto leafNode = newLeafNode(k, v, remaining);
+                    linkLeaf(leafNode->leaf, pred);
+                    splitNode->addEdge({remaining[0], leafNode});
+                    path.push_back({leafNode, k.size(), 0});
+                    pred = leafNode->leaf;
+                    break;
+                }
+            }
+
+            while (!path.empty()) {
+                close();
+            }
+            size += inserted;
+            return inserted;
+        }
+
+        // Deletes k, returning its value and whether it was present
+        std::tuple<std::optional<T>, bool> del(KeyViewOf<K> k) {
+            auto result = del(root, k);
+            if (!result.leaf) {
+                return {std::nullopt, false};
+            }
+            root = result.node;
+            std::optional<T> oldVal = result.leaf->val;
+            retireLeaf(result.leaf);
+            return {oldVal, true};
+        }
+
+        // Deletes every key starting with prefix and returns how many there were
+        int deletePrefix(KeyViewOf<K> prefix) {
+            auto result = deletePrefix(root, prefix);
+            if (result.node) {
+                root = result.node;
+            } else if (result.numDeletions > 0) {
+                // The whole tree was under the prefix
+                retireSubtree(root);
+                root = newNode();
+            }
+            return result.numDeletions;
+        }
+
+        // Inserts k under n, where search is the part of k below n, and
+        // returns the node that replaces n. pred is the largest leaf smaller
+        // than every key under n, if any; it is refined on the way down so the
+        // new leaf is spliced into the leaf list directly, and only the nodes
+        // on the path are updated.
+        std::tuple<Node<K, T>*, std::optional<T>, bool> insert(
+            Node<K, T>* n,
+            KeyViewOf<K> k,
+            KeyViewOf<K> search,
+            const T& v,
+            LeafNode<K, T>* pred = nullptr) {
             std::optional<T> oldVal;
-            bool didUpdate = false;
+            n = writable(n);
 
             // Handle key exhaustion
             if (search.empty()) {
                 if (n->leaf) {
                     oldVal = n->leaf->val;
-                    didUpdate = true;
+                    if (owns(n->leaf)) {
+                        // Update the existing leaf in place, its links stay valid
+                        n->leaf->val = v;
+                    } else {
+                        // Older versions keep the old leaf; the new one takes
+                        // its place in the leaf list
+                        auto old = n->leaf;
+                        n->leaf = newLeaf(k, v);
+                        relink({LeafLink::kReplace, old, n->leaf});
+                        retireLeaf(old);
+                        n->updateMinMaxLeaves();
+                    }
+                    return {n, oldVal, true};
                 }
-                n->leaf = std::make_shared<LeafNode<K, T>>(k, v);
-                n->computeLinks();
-                return {n, oldVal, didUpdate};
+                n->leaf = newLeaf(k, v);
+                linkLeaf(n->leaf, pred);
+                adjustPath(n, 1);
+                return {n, oldVal, false};
+            }
+
+            // The node's own key and its children below the search label
+            // sort before the new key
+            auto label = static_cast<uint8_t>(search[0]);
+            if (n->leaf) {
+                pred = n->leaf;
+            }
+            if (auto below = n->edges.before(label)) {
+                pred = below->maxLeaf;
             }
 
             // Look for the edge
-            int idx;
-            auto child = n->getEdge(search[0], &idx);
+            auto child = n->getEdge(search[0]);
 
             // No edge, create one
             if (!child) {
-                auto leaf = std::make_shared<LeafNode<K, T>>(k, v);
-                auto newNode = std::make_shared<Node<K, T>>();
-                newNode->leaf = leaf;
-                newNode->minLeaf = leaf.get();
-                newNode->maxLeaf = leaf.get();
-                newNode->prefix = search;
-                newNode->leaves_in_subtree = 1;
-
                 Edge<K, T> e;
                 e.label = search[0];
-                e.node = newNode;
+                e.node = newLeafNode(k, v, search);
+                linkLeaf(e.node->leaf, pred);
                 n->addEdge(e);
-                n->computeLinks();
+                adjustPath(n, 1);
                 return {n, std::nullopt, false};
             }
 
             // Determine longest prefix of the search key on match
             int commonPrefix = longestPrefix(search, child->prefix);
             if (commonPrefix == child->prefix.size()) {
-                K newSearch(search.begin() + commonPrefix, search.end());
-                auto [newChild, oldVal, didUpdate] = insert(child, k, newSearch, v);
+                auto [newChild, oldVal, didUpdate] = insert(child, k, search.substr(commonPrefix), v, pred);
                 if (newChild) {
-                    n->edges[idx].node = newChild;
-                    n->computeLinks();
+                    n->edges.replace(label, newChild);
+                    // An update may have replaced the min or max leaf
+                    adjustPath(n, didUpdate ? 0 : 1);
                     return {n, oldVal, didUpdate};
                 }
                 return {nullptr, oldVal, didUpdate};
             }
 
-            // Optimized split: minimize allocations
-            // Instead of creating a new split node, we can sometimes modify the existing child
-            if (commonPrefix == 0) {
-                // No common prefix, just add as a new edge
-                auto leaf = std::make_shared<LeafNode<K, T>>(k, v);
-                auto newNode = std::make_shared<Node<K, T>>();
-                newNode->leaf = leaf;
-                newNode->minLeaf = leaf.get();
-                newNode->maxLeaf = leaf.get();
-                newNode->prefix = search;
-                newNode->leaves_in_subtree = 1;
-
-                Edge<K, T> e;
-                e.label = search[0];
-                e.node = newNode;
-                n->addEdge(e);
-                n->computeLinks();
-                return {n, std::nullopt, false};
-            }
-
             // We need to split - create minimal new structure
-            auto splitNode = std::make_shared<Node<K, T>>();
-            splitNode->prefix = K(search.begin(), search.begin() + commonPrefix);
+            auto splitNode = newNode();
+            splitNode->prefix.assign(KeyViewOf<K>(search.data(), commonPrefix), arena.keys);
 
             // Move existing child under split node
             Edge<K, T> childEdge;
             childEdge.label = child->prefix[commonPrefix];
+            child = writable(child);
             childEdge.node = child;
             splitNode->addEdge(childEdge);
-            child->prefix = K(child->prefix.begin() + commonPrefix, child->prefix.end());
+            child->prefix.assign(KeyViewOf<K>(child->prefix).substr(commonPrefix), arena.keys);
+            splitNode->leaves_in_subtree = child->leaves_in_subtree;
 
             // Handle the new key
-            K remainingSearch(search.begin() + commonPrefix, search.end());
+            KeyViewOf<K> remainingSearch = search.substr(commonPrefix);
             if (remainingSearch.empty()) {
-                // New key ends at split node
-                auto leaf = std::make_shared<LeafNode<K, T>>(k, v);
+                // New key ends at split node, before the whole old subtree
+                auto leaf = newLeaf(k, v);
+                linkLeaf(leaf, pred);
                 splitNode->leaf = leaf;
-                splitNode->minLeaf = leaf.get();
-                splitNode->maxLeaf = leaf.get();
-                splitNode->leaves_in_subtree++;
             } else {
-                // New key continues
-                auto leaf = std::make_shared<LeafNode<K, T>>(k, v);
-                auto newNode = std::make_shared<Node<K, T>>();
-                newNode->leaf = leaf;
-                newNode->minLeaf = leaf.get();
-                newNode->maxLeaf = leaf.get();
-                newNode->prefix = remainingSearch;
-                newNode->leaves_in_subtree = 1;
-
+                // New key continues, on one side of the old subtree
+                if (static_cast<uint8_t>(remainingSearch[0]) > static_cast<uint8_t>(childEdge.label)) {
+                    pred = child->maxLeaf;
+                }
                 Edge<K, T> newEdge;
                 newEdge.label = remainingSearch[0];
-                newEdge.node = newNode;
+                newEdge.node = newLeafNode(k, v, remainingSearch);
+                linkLeaf(newEdge.node->leaf, pred);
                 splitNode->addEdge(newEdge);
             }
+            adjustPath(splitNode, 1);
 
             // Update parent
             Edge<K, T> splitEdge;
             splitEdge.label = search[0];
             splitEdge.node = splitNode;
             n->replaceEdge(splitEdge);
-            
-            splitNode->computeLinks();
-            n->computeLinks();
+            adjustPath(n, 1);
             return {n, std::nullopt, false};
         }
 
-        DeleteResult<K, T> del(std::shared_ptr<Node<K, T>> parent, std::shared_ptr<Node<K, T>> n, const K& search) {
+        // Deletes search from the subtree at n and returns the node that
+        // replaces n, or nullptr if n goes away. The removed leaf is detached
+        // but not released, so the caller can still read its value. Nothing
+        // is copied unless a key is actually removed.
+        DeleteResult<K, T> del(Node<K, T>* n, KeyViewOf<K> search) {
             DeleteResult<K, T> result;
-            result.node = nullptr;
+            result.node = n;
             result.leaf = nullptr;
+            bool isRoot = n == root;
 
             // If we're at the end of the search, we're deleting
             if (search.empty()) {
-                if (n->leaf) {
-                    // Delete the leaf
-                    result.leaf = n->leaf;
-                    n->leaf = nullptr;
-                    n->minLeaf = nullptr;
-                    n->maxLeaf = nullptr;
-                    size--;
-
-                    // If the node has no edges, it can be removed
-                    if (n->edges.empty()) {
-                        return result;
-                    }
+                if (!n->leaf) {
+                    return result;
+                }
+                // Delete the leaf
+                result.leaf = n->leaf;
+                unlinkLeaves(n->leaf, n->leaf);
+                size--;
+
+                // If the node has no edges, it can be removed
+                if (!isRoot && n->edges.empty()) {
+                    result.node = nullptr;
+                    return result;
+                }
 
-                    // If the node has only one edge, merge with the child
-                    if (n->edges.size() == 1) {
-                        mergeChild(n);
-                        result.node = n;
-                        return result;
-                    }
+                n = writable(n);
+                n->leaf = nullptr;
+                result.node = n;
 
-                    // Otherwise, just update the node
-                    n->computeLinks();
-                    result.node = n;
+                // If the node has only one edge, merge with the child
+                if (!isRoot && n->edges.size() == 1) {
+                    mergeChild(n);
                     return result;
                 }
+
+                // Otherwise, just update the node
+                adjustPath(n, -1);
                 return result;
             }
 
-            // Look for an edge
-            if (search.empty()) {
-                result.node = n;
+            // Consume the search prefix
+            auto child = n->getEdge(search[0]);
+            if (!child || !hasPrefix(search, child->prefix)) {
                 return result;
             }
-            int idx;
-            auto child = n->getEdge(search[0], &idx);
-            if (child) {
-                // Consume the search prefix
-                K newSearch = search;
-                if (!child->prefix.empty() && !newSearch.empty()) {
-                    if (child->prefix.size() < newSearch.size()) {
-                        K searchPrefix(newSearch.begin(), newSearch.begin() + child->prefix.size());
-                        if (child->prefix != searchPrefix) {
-                            result.node = n;
-                            return result;
-                        }
-                        newSearch = K(newSearch.begin() + child->prefix.size(), newSearch.end());
-                    } else {
-                        if (child->prefix != newSearch) {
-                            result.node = n;
-                            return result;
-                        }
-                        newSearch.clear();
-                    }
-                }
 
-                // Recursively delete
-                auto delResult = del(n, child, newSearch);
-                if (delResult.node) {
-                    Edge<K, T> e = n->edges[idx];
-                    e.node = delResult.node;
-                    n->replaceEdge(e);
-                } else {
-                    n->edges.erase(n->edges.begin() + idx);
-                    if (n->edges.empty() && !n->leaf) {
-                        return result;
-                    }
-                    // Check if we should merge after edge deletion
-                    if (n->edges.size() == 1 && !n->leaf) {
-                        mergeChild(n);
-                    }
-                }
+            // Recursively delete
+            auto delResult = del(child, search.substr(child->prefix.size()));
+            if (!delResult.leaf) {
+                return result;
+            }
+            result.leaf = delResult.leaf;
 
-                // Update min/max leaves
-                n->computeLinks();
-                result.node = n;
-                result.leaf = delResult.leaf;
+            // The child was this node's only content, so it goes too
+            if (!delResult.node && !isRoot && !n->leaf && n->edges.size() == 1) {
+                retire(child);
+                result.node = nullptr;
                 return result;
             }
 
+            n = writable(n);
             result.node = n;
+            if (delResult.node) {
+                n->edges.replace(static_cast<uint8_t>(search[0]), delResult.node);
+            } else {
+                n->delEdge(search[0]);
+                retire(child);
+                // Check if we should merge after edge deletion
+                if (!isRoot && n->edges.size() == 1 && !n->leaf) {
+                    mergeChild(n);
+                    return result;
+                }
+            }
+
+            // Update min/max leaves
+            adjustPath(n, -1);
             return result;
         }
 
-        DeletePrefixResult<K, T> deletePrefix(std::shared_ptr<Node<K, T>> n, const K& search) {
+        DeletePrefixResult<K, T> deletePrefix(Node<K, T>* n, KeyViewOf<K> search) {
             DeletePrefixResult<K, T> result;
-            result.node = nullptr;
+            result.node = n;
             result.numDeletions = 0;
+            bool isRoot = n == root;
 
             // Handle key exhaustion
             if (search.empty()) {
                 // Delete all leaves under this node
-                int count = 0;
-                std::function<void(std::shared_ptr<Node<K, T>>)> countLeaves = [&count, &countLeaves](std::shared_ptr<Node<K, T>> node) {
-                    if (node->leaf) {
-                        count++;
-                    }
-                    for (const auto& edge : node->edges) {
-                        countLeaves(edge.node);
-                    }
-                };
-                countLeaves(n);
+                int count = trackChannelsAndCount(n);
+                if (count > 0) {
+                    unlinkLeaves(n->minLeaf, n->maxLeaf);
+                }
                 size -= count;
+                result.node = nullptr;
                 result.numDeletions = count;
                 return result;
             }
 
             // Look for an edge
-            int idx;
-            auto child = n->getEdge(search[0], &idx);
-            if (child) {
-                // Consume the search prefix
-                K newSearch = search;
-                if (!child->prefix.empty() && !newSearch.empty()) {
-                    if (child->prefix.size() < newSearch.size()) {
-                        K searchPrefix(newSearch.begin(), newSearch.begin() + child->prefix.size());
-                        if (child->prefix != searchPrefix) {
-                            result.node = n;
-                            return result;
-                        }
-                        newSearch = K(newSearch.begin() + child->prefix.size(), newSearch.end());
-                    } else {
-                        if (child->prefix != newSearch) {
-                            result.node = n;
-                            return result;
-                        }
-                        newSearch.clear();
-                    }
-                }
+            auto child = n->getEdge(search[0]);
+            if (!child) {
+                return result;
+            }
 
-                // Recursively delete
-                auto delResult = deletePrefix(child, newSearch);
-                if (delResult.node) {
-                    Edge<K, T> e = n->edges[idx];
-                    e.node = delResult.node;
-                    n->replaceEdge(e);
-                } else {
-                    n->edges.erase(n->edges.begin() + idx);
-                    if (n->edges.empty() && !n->leaf) {
-                        return result;
-                    }
-                    // Check if we should merge after edge deletion
-                    if (n->edges.size() == 1 && !n->leaf) {
-                        mergeChild(n);
-                    }
+            // Consume the search prefix; the child's whole subtree matches
+            // once the search runs out inside its prefix
+            KeyViewOf<K> newSearch;
+            if (child->prefix.size() < search.size()) {
+                if (!hasPrefix(search, child->prefix)) {
+                    return result;
                 }
+                newSearch = search.substr(child->prefix.size());
+            } else if (!hasPrefix(child->prefix, search)) {
+                return result;
+            }
 
-                // Update min/max leaves
-                n->computeLinks();
-                result.node = n;
-                result.numDeletions = delResult.numDeletions;
+            // Recursively delete
+            auto delResult = deletePrefix(child, newSearch);
+            if (delResult.numDeletions == 0) {
+                return result;
+            }
+            result.numDeletions = delResult.numDeletions;
+
+            // The child was this node's only content, so it goes too
+            if (!delResult.node && !isRoot && !n->leaf && n->edges.size() == 1) {
+                retireSubtree(child);
+                result.node = nullptr;
                 return result;
             }
 
+            n = writable(n);
             result.node = n;
+            if (delResult.node) {
+                n->edges.replace(static_cast<uint8_t>(search[0]), delResult.node);
+            } else {
+                n->delEdge(search[0]);
+                retireSubtree(child);
+                // Check if we should merge after edge deletion
+                if (!isRoot && n->edges.size() == 1 && !n->leaf) {
+                    mergeChild(n);
+                    return result;
+                }
+            }
+
+            // Update min/max leaves
+            adjustPath(n, -delResult.numDeletions);
             return result;
         }
 
-        void mergeChild(std::shared_ptr<Node<K, T>> n) {
+        // Folds the only child of n into n, which must be writable
+        void mergeChild(Node<K, T>* n) {
             if (n->edges.size() != 1) {
                 return;
             }
 
-            auto child = n->edges[0].node;
-            
+            auto child = n->edges.front();
+
             // Merge the nodes by copying child's properties to parent
-            n->prefix = concat(n->prefix, child->prefix);
+            K merged(n->prefix.begin(), n->prefix.end());
+            merged.insert(merged.end(), child->prefix.begin(), child->prefix.end());
+            n->prefix.assign(merged, arena.keys);
             n->leaf = child->leaf;
             n->minLeaf = child->minLeaf;
             n->maxLeaf = child->maxLeaf;
             n->leaves_in_subtree = child->leaves_in_subtree;
-            
-            if (!child->edges.empty()) {
-                n->edges = child->edges;
+            if (owns(child)) {
+                n->edges.swap(child->edges);
             } else {
-                n->edges.clear();
+                n->edges = child->edges;
             }
+            retire(child);
         }
 
-        int trackChannelsAndCount(std::shared_ptr<Node<K, T>> n) {
-            int count = 0;
-            std::function<void(std::shared_ptr<Node<K, T>>)> countLeaves = [&count, &countLeaves](std::shared_ptr<Node<K, T>> node) {
-                if (node->leaf) {
-                    count++;
-                }
-                for (const auto& edge : node->edges) {
-                    countLeaves(edge.node);
-                }
-            };
-            countLeaves(n);
-            return count;
+        int trackChannelsAndCount(Node<K, T>* n) {
+            return n->leaves_in_subtree;
         }
 
+        // Starts another isolated transaction on the same tree
         Transaction clone() {
             return Transaction(tree);
         }
 
+        // Publishes the transaction's version to the tree it was started on
+        // and returns it. A committed transaction takes no further writes.
         Tree<K, T> commit() {
-            tree.root = root;
-            tree.size = size;
+            publish();
             return tree;
         }
 
+        // Returns the transaction's version as a tree without publishing it
         Tree<K, T> commitOnly() {
-            return tree;
+            finishLinks(false);
+            committed = true;
+            return Tree<K, T>(tree.arena, version, root, size);
         }
     };
 
+    // txn starts an isolated transaction on the tree
     Transaction txn() {
         return Transaction(*this);
     }
 
+    // insert, del and deletePrefix write through a one-off transaction and
+    // update this tree in place; other copies of the tree keep their
+    // contents. The returned tree is a copy of the updated one.
     std::tuple<Tree<K, T>, std::optional<T>, bool> insert(const K& k, const T& v) {
-        auto txn = this->txn();
-        auto [newRoot, oldVal, didUpdate] = txn.insert(root, k, k, v);
-        root = newRoot;
-        if (!didUpdate) {
-            size++;
-        }
+        Transaction txn(*this, false);
+        auto [oldVal, didUpdate] = txn.insert(k, v);
+        txn.publish();
         return {*this, oldVal, didUpdate};
     }
 
     std::tuple<Tree<K, T>, std::optional<T>, bool> del(const K& k) {
-        auto txn = this->txn();
-        auto result = txn.del(nullptr, root, k);
-        if (result.node) {
-            root = result.node;
-        }
-        return {*this, result.leaf ? std::optional<T>(result.leaf->val) : std::nullopt, result.leaf != nullptr};
+        Transaction txn(*this, false);
+        auto [oldVal, found] = txn.del(k);
+        txn.publish();
+        return {*this, oldVal, found};
     }
 
     std::tuple<Tree<K, T>, bool, int> deletePrefix(const K& k) {
-        auto txn = this->txn();
-        auto result = txn.deletePrefix(root, k);
-        if (result.node) {
-            root = result.node;
+        Transaction txn(*this, false);
+        int numDeletions = txn.deletePrefix(k);
+        txn.publish();
+        return {*this, numDeletions > 0, numDeletions};
+    }
+
+    // insertBatch inserts many (key, value) pairs in one transaction and
+    // returns how many keys were new. Pairs are inserted in key order, each
+    // resuming from where the previous one left the tree (see
+    // Transaction::insertSorted); input that is not already sorted is
+    // ordered through pointers first, leaving the pairs where they are. A key
+    // repeated in the batch keeps its last value, like insert.
+    template<typename It>
+    int insertBatch(It begin, It end) {
+        Transaction txn(*this, false);
+        auto byKey = [](const auto& a, const auto& b) { return entryOf(a).first < entryOf(b).first; };
+        int inserted;
+        if (std::is_sorted(begin, end, byKey)) {
+            inserted = txn.insertSorted(begin, end);
+        } else {
+            std::vector<const typename std::iterator_traits<It>::value_type*> sorted;
+            for (auto it = begin; it != end; ++it) {
+                sorted.push_back(&*it);
+            }
+            std::stable_sort(sorted.begin(), sorted.end(), byKey);
+            inserted = txn.insertSorted(sorted.begin(), sorted.end());
         }
-        return {*this, result.numDeletions > 0, result.numDeletions};
+        txn.publish();
+        return inserted;
+    }
+
+    template<typename Container>
+    int insertBatch(const Container& entries) {
+        return insertBatch(entries.begin(), entries.end());
     }
 
     std::optional<T> Get(const K& search) const {
+        return Get(KeyViewOf<K>(search));
+    }
+
+    // Get overload for any contiguous view of key elements (string_view,
+    // span, a slice of a network buffer, ...), so no K has to be built
+    std::optional<T> Get(KeyViewOf<K> search) const {
         T result;
         if (root->Get(search, result)) {
             return result;
@@ -480,59 +1730,292 @@ public:
         return std::nullopt;
     }
 
+    // multiGet looks up count keys at once and stores each result in out.
+    // Up to kMultiGetWidth lookups advance in turns, one step each, and every
+    // step prefetches the memory the lookup's next step reads: the next
+    // node, the part of its edge table holding the next label, or the leaf.
+    // By the time a lookup's turn comes round its data is usually in cache,
+    // so on trees much larger than the cache the misses of a batch overlap
+    // instead of adding up. Keys may be K or any contiguous view of it.
+    template<typename Key>
+    void multiGet(const Key* keys, size_t count, std::optional<T>* out) const {
+        enum Step : uint8_t { kNode, kEdge, kLeaf, kDone };
+        struct Lookup {
+            const Node<K, T>* n;
+            KeyViewOf<K> search;
+            size_t index;
+            Step step;
+        };
+
+        Lookup window[kMultiGetWidth];
+        for (auto& l : window) {
+            l.step = kDone;
+        }
+        size_t next = 0;
+        size_t active = 0;
+        auto start = [&](Lookup& l) {
+            l = {root, KeyViewOf<K>(keys[next]), next, kNode};
+            next++;
+            active++;
+        };
+        for (size_t i = 0; i < kMultiGetWidth && next < count; i++) {
+            start(window[i]);
+        }
+
+        while (active > 0) {
+            for (size_t i = 0; i < kMultiGetWidth; i++) {
+                auto& l = window[i];
+                switch (l.step) {
+                    case kNode:
+                        if (!hasPrefix(l.search, l.n->prefix)) {
+                            out[l.index] = std::nullopt;
+                            l.step = kDone;
+                            break;
+                        }
+                        l.search = l.search.substr(l.n->prefix.size());
+                        if (l.search.empty()) {
+                            __builtin_prefetch(l.n->leaf);
+                            l.step = kLeaf;
+                        } else {
+                            l.n->edges.prefetch(l.search[0]);
+                            l.step = kEdge;
+                        }
+                        break;
+                    case kEdge:
+                        l.n = l.n->getEdge(l.search[0]);
+                        if (!l.n) {
+                            out[l.index] = std::nullopt;
+                            l.step = kDone;
+                            break;
+                        }
+                        __builtin_prefetch(l.n);
+                        l.step = kNode;
+                        break;
+                    case kLeaf:
+                        out[l.index] = l.n->leaf ? std::optional<T>(l.n->leaf->val) : std::nullopt;
+                        l.step = kDone;
+                        break;
+                    default:
+                        continue;
+                }
+                if (l.step == kDone) {
+                    active--;
+                    if (next < count) {
+                        start(l);
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<std::optional<T>> multiGet(const std::vector<K>& keys) const {
+        std::vector<std::optional<T>> out(keys.size());
+        multiGet(keys.data(), keys.size(), out.data());
+        return out;
+    }
+
     LongestPrefixResult<K, T> LongestPrefix(const K& search) const {
         return root->LongestPrefix(search);
     }
 
+    LongestPrefixResult<K, T> LongestPrefix(KeyViewOf<K> search) const {
+        return root->LongestPrefix(search);
+    }
+
     // GetAtIndex is used to lookup a specific key, returning
     // the value and if it was found
     std::tuple<K, T, bool> GetAtIndex(int index) const {
         return root->GetAtIndex(index);
     }
 
+    // rank returns the number of keys less than key, which is the index
+    // GetAtIndex gives key if it is in the tree. The walk follows key's
+    // path and adds up the counts of the subtrees it passes on the left
+    // (see seekBound).
+    int rank(const K& key) const {
+        return rank(KeyViewOf<K>(key));
+    }
+
+    int rank(KeyViewOf<K> key) const {
+        int before;
+        seekBound(root, key, false, before);
+        return before;
+    }
+
+    // countRange returns the number of keys in [lo, hi)
+    int countRange(const K& lo, const K& hi) const {
+        return countRange(KeyViewOf<K>(lo), KeyViewOf<K>(hi));
+    }
+
+    int countRange(KeyViewOf<K> lo, KeyViewOf<K> hi) const {
+        return std::max(rank(hi) - rank(lo), 0);
+    }
+
+    // countPrefix returns the number of keys starting with prefix, read off
+    // the node the prefix leads to
+    int countPrefix(const K& prefix) const {
+        return countPrefix(KeyViewOf<K>(prefix));
+    }
+
+    int countPrefix(KeyViewOf<K> prefix) const {
+        auto n = findPrefixNode(prefix);
+        return n ? n->leaves_in_subtree : 0;
+    }
+
+    // walk calls fn(key, val) on every key in order, where key is a view of
+    // the stored key and val refers to the stored value. fn is inlined into
+    // the loop; returning false from it ends the walk. It descends through
+    // the nodes rather than following the leaf list, so any snapshot can be
+    // walked while other copies of the tree are read or written.
+    template<typename F>
+    void walk(F&& fn) const {
+        walkNodes(root, 0, root->leaves_in_subtree, fn);
+    }
+
+    // walkPrefix calls fn on the keys starting with prefix, in order
+    template<typename F>
+    void walkPrefix(const K& prefix, F&& fn) const {
+        walkPrefix(KeyViewOf<K>(prefix), fn);
+    }
+
+    template<typename F>
+    void walkPrefix(KeyViewOf<K> prefix, F&& fn) const {
+        if (auto n = findPrefixNode(prefix)) {
+            walkNodes(n, 0, n->leaves_in_subtree, fn);
+        }
+    }
+
+    // walkPath calls fn on the keys that are prefixes of path, shortest
+    // first, by walking down path's nodes; each is reached on the exact
+    // path, so none needs comparing with path
+    template<typename F>
+    void walkPath(const K& path, F&& fn) const {
+        walkPath(KeyViewOf<K>(path), fn);
+    }
+
+    template<typename F>
+    void walkPath(KeyViewOf<K> path, F&& fn) const {
+        const Node<K, T>* n = root;
+        while (true) {
+            if (n->leaf && !visit(fn, n->leaf)) {
+                return;
+            }
+            if (path.empty()) {
+                return;
+            }
+            n = n->getEdge(path[0]);
+            if (!n || !hasPrefix(path, n->prefix)) {
+                return;
+            }
+            path = path.substr(n->prefix.size());
+        }
+    }
+
+    // parallelForEach calls fn(key, val) on every key like walk, but splits
+    // the keys into chunks of equal count and walks each chunk on its own
+    // thread. A chunk descends to its first key by index, as GetAtIndex
+    // does, and walks the nodes from there, so a snapshot can be scanned
+    // while other copies of the tree are read or written. Keys are visited
+    // in order within a chunk
+    // but chunks run at once, so fn must be safe to call concurrently.
+    // Returning false from fn stops every worker at its next key. threads
+    // == 0 uses one per hardware thread; small trees use fewer.
+    template<typename F>
+    void parallelForEach(F&& fn, unsigned threads = 0) const {
+        parallelForEachFrom(root, fn, threads);
+    }
+
+    // parallelForEachPrefix is parallelForEach over the keys starting with
+    // prefix, the range seekPrefix iterates
+    template<typename F>
+    void parallelForEachPrefix(const K& prefix, F&& fn, unsigned threads = 0) const {
+        parallelForEachPrefix(KeyViewOf<K>(prefix), fn, threads);
+    }
+
+    template<typename F>
+    void parallelForEachPrefix(KeyViewOf<K> prefix, F&& fn, unsigned threads = 0) const {
+        if (auto n = findPrefixNode(prefix)) {
+            parallelForEachFrom(n, fn, threads);
+        }
+    }
+
+    // parallelReduce folds every key into a result on several threads.
+    // Each chunk starts from identity and folds its keys in order with
+    // acc = fold(acc, key, val); the chunk results are then merged in key
+    // order with combine(left, right), so combine need not commute.
+    template<typename R, typename F, typename Combine>
+    R parallelReduce(R identity, F&& fold, Combine&& combine, unsigned threads = 0) const {
+        return parallelReduceFrom(root, std::move(identity), fold, combine, threads);
+    }
+
+    // parallelReducePrefix is parallelReduce over the keys starting with
+    // prefix; it returns identity if there are none
+    template<typename R, typename F, typename Combine>
+    R parallelReducePrefix(const K& prefix, R identity, F&& fold, Combine&& combine, unsigned threads = 0) const {
+        return parallelReducePrefix(KeyViewOf<K>(prefix), std::move(identity), fold, combine, threads);
+    }
+
+    template<typename R, typename F, typename Combine>
+    R parallelReducePrefix(KeyViewOf<K> prefix, R identity, F&& fold, Combine&& combine, unsigned threads = 0) const {
+        auto n = findPrefixNode(prefix);
+        return n ? parallelReduceFrom(n, std::move(identity), fold, combine, threads) : identity;
+    }
+
     Iterator<K, T> iterator() const {
-        return Iterator<K, T>(root);
+        return Iterator<K, T>(root, ownsLeafList());
+    }
+
+    ReverseIterator<K, T> reverseIterator() const {
+        return ReverseIterator<K, T>(root, ownsLeafList());
     }
 
     // Range-based for loop support
     Iterator<K, T> begin() const {
-        return Iterator<K, T>(root);
+        return Iterator<K, T>(root, ownsLeafList());
     }
 
     Iterator<K, T> end() const {
-        return Iterator<K, T>(nullptr);
+        return Iterator<K, T>(root).end();
+    }
+
+    // Reverse range, from the largest key down
+    ReverseIterator<K, T> rbegin() const {
+        return ReverseIterator<K, T>(root, ownsLeafList());
     }
 
-    // PrefixIterator returns an iterator that walks down the tree following a path
+    ReverseIterator<K, T> rend() const {
+        return ReverseIterator<K, T>(root).end();
+    }
+
+    // PrefixIterator returns an iterator that walks down the tree following
+    // a path. It reads the path as it goes, so a borrowed key must outlive
+    // it; a temporary is moved into the iterator instead.
     PrefixIterator<K, T> prefixIterator(const K& key) const {
         return PrefixIterator<K, T>(root, key);
     }
 
+    PrefixIterator<K, T> prefixIterator(K&& key) const {
+        return PrefixIterator<K, T>(root, std::move(key));
+    }
+
+    PrefixIterator<K, T> prefixIterator(KeyViewOf<K> key) const {
+        return PrefixIterator<K, T>(root, key);
+    }
+
     // findMatchingPrefixes finds all keys that are prefixes of the given key
-    // using PrefixIterator to walk down the tree following the search key path
+    // by walking down the tree along the search key path
     std::vector<std::pair<K, T>> findMatchingPrefixes(const K& searchKey) const {
+        return findMatchingPrefixes(KeyViewOf<K>(searchKey));
+    }
+
+    std::vector<std::pair<K, T>> findMatchingPrefixes(KeyViewOf<K> search) const {
         std::vector<std::pair<K, T>> results;
-        
-        if (searchKey.empty()) {
+        if (search.empty()) {
             return results;
         }
-        
-        // Use PrefixIterator to walk down the tree following the search key path
-        auto prefixIter = prefixIterator(searchKey);
-        
-        // Collect all leaf nodes along the path
-        while (true) {
-            auto result = prefixIter.next();
-            if (!result.found) {
-                break;
-            }
-            
-            // Check if this key is a prefix of the search key
-            if (hasPrefix(searchKey, result.key)) {
-                results.push_back({result.key, result.val});
-            }
-        }
-        
+        walkPath(search, [&](KeyViewOf<K> key, const T& val) {
+            results.push_back({K(key.begin(), key.end()), val});
+        });
         return results;
     }
 };
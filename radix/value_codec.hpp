@@ -0,0 +1,277 @@
+//
+// Created by Ashesh Vidyut on 22/03/25.
+//
+
+#ifndef VALUE_CODEC_H
+#define VALUE_CODEC_H
+
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+// ValueCodec turns a tree's values into bytes and back for the on-disk
+// formats. Trivially copyable values are stored as their object bytes and
+// strings as their characters; the length is stored next to the bytes, so
+// a codec only has to handle the value itself. Other value types need a
+// specialization with the same two members.
+template<typename T, typename Enable = void>
+struct ValueCodec {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "values that are not trivially copyable need a ValueCodec specialization");
+
+    static void encode(const T& v, std::string& out) {
+        out.append(reinterpret_cast<const char*>(&v), sizeof(T));
+    }
+
+    // Returns false if the bytes cannot hold a T
+    static bool decode(const char* p, size_t n, T& v) {
+        if (n != sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&v, p, n);
+        return true;
+    }
+};
+
+template<typename C>
+struct ValueCodec<std::basic_string<C>> {
+    static void encode(const std::basic_string<C>& v, std::string& out) {
+        out.append(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(C));
+    }
+
+    static bool decode(const char* p, size_t n, std::basic_string<C>& v) {
+        if (n % sizeof(C) != 0) {
+            return false;
+        }
+        v.resize(n / sizeof(C));
+        std::memcpy(&v[0], p, n);
+        return true;
+    }
+};
+
+// Checksum is a 64-bit checksum of a byte stream, fed in pieces of any
+// size. It mixes a word at a time and is meant to catch torn or corrupted
+// files, not tampering.
+class Checksum {
+private:
+    uint64_t hash = 0x6a09e667f3bcc908ull;
+    uint64_t tail = 0;      // bytes not yet making up a whole word
+    unsigned tailLen = 0;
+    uint64_t total = 0;
+
+    void mix(uint64_t word) {
+        hash ^= word * 0x9e3779b97f4a7c15ull;
+        hash = ((hash << 31) | (hash >> 33)) * 0xbf58476d1ce4e5b9ull;
+    }
+
+public:
+    void update(const void* data, size_t n) {
+        auto p = static_cast<const unsigned char*>(data);
+        total += n;
+        while (n > 0 && tailLen > 0) {
+            tail |= static_cast<uint64_t>(*p++) << (8 * tailLen++);
+            n--;
+            if (tailLen == 8) {
+                mix(tail);
+                tail = 0;
+                tailLen = 0;
+            }
+        }
+        for (; n >= 8; p += 8, n -= 8) {
+            uint64_t word;
+            std::memcpy(&word, p, 8);
+            mix(word);
+        }
+        for (; n > 0; n--) {
+            tail |= static_cast<uint64_t>(*p++) << (8 * tailLen++);
+        }
+    }
+
+    uint64_t value() const {
+        Checksum c = *this;
+        c.mix(c.tail);
+        c.mix(c.total);
+        return c.hash ^ (c.hash >> 32);
+    }
+};
+
+// Varints in the StreamWriter encoding, for formats that build their
+// records in a buffer first
+inline void appendVarint(std::string& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+// Reads a varint at p, advancing p; fails if it runs past end
+inline bool readVarint(const char*& p, const char* end, uint64_t& v) {
+    v = 0;
+    for (unsigned shift = 0; shift < 64 && p < end; shift += 7) {
+        auto b = static_cast<uint8_t>(*p++);
+        v |= static_cast<uint64_t>(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// StreamWriter buffers bytes for an ostream and checksums them as they go
+// out, so a format can be written incrementally however large it is
+class StreamWriter {
+private:
+    static constexpr size_t kBufferSize = 64 * 1024;
+
+    std::ostream& out;
+    std::string buf;
+    Checksum sum;
+
+public:
+    explicit StreamWriter(std::ostream& o) : out(o) {
+        buf.reserve(kBufferSize);
+    }
+
+    void put(const void* data, size_t n) {
+        if (buf.size() + n > kBufferSize) {
+            flush();
+        }
+        if (n > kBufferSize) {
+            sum.update(data, n);
+            out.write(static_cast<const char*>(data), n);
+            return;
+        }
+        buf.append(static_cast<const char*>(data), n);
+    }
+
+    void putByte(uint8_t b) {
+        if (buf.size() == kBufferSize) {
+            flush();
+        }
+        buf.push_back(static_cast<char>(b));
+    }
+
+    // Seven bits per byte, low bits first, high bit set on all but the last
+    void putVarint(uint64_t v) {
+        while (v >= 0x80) {
+            putByte(static_cast<uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        putByte(static_cast<uint8_t>(v));
+    }
+
+    // Checksum of everything put so far
+    uint64_t checksum() {
+        flush();
+        return sum.value();
+    }
+
+    bool flush() {
+        sum.update(buf.data(), buf.size());
+        out.write(buf.data(), buf.size());
+        buf.clear();
+        return static_cast<bool>(out);
+    }
+};
+
+// StreamReader reads what a StreamWriter wrote, checksumming it as it is
+// read. It reads through the stream's buffer, so nothing past the bytes
+// asked for is consumed from the stream. Bytes read are staged and
+// checksummed a block at a time, as the writer does.
+class StreamReader {
+private:
+    static constexpr size_t kStageSize = 4096;
+
+    std::streambuf* in;
+    Checksum sum;
+    char stage[kStageSize];
+    size_t staged = 0;
+
+    void stageBytes(const char* p, size_t n) {
+        if (staged + n > kStageSize) {
+            sum.update(stage, staged);
+            staged = 0;
+            if (n > kStageSize) {
+                sum.update(p, n);
+                return;
+            }
+        }
+        std::memcpy(stage + staged, p, n);
+        staged += n;
+    }
+
+public:
+    explicit StreamReader(std::istream& i) : in(i.rdbuf()) {}
+
+    bool get(void* data, size_t n) {
+        if (n == 0) {
+            return true;
+        }
+        if (static_cast<size_t>(in->sgetn(static_cast<char*>(data), n)) != n) {
+            return false;
+        }
+        stageBytes(static_cast<const char*>(data), n);
+        return true;
+    }
+
+    bool getByte(uint8_t& b) {
+        auto c = in->sbumpc();
+        if (c == std::char_traits<char>::eof()) {
+            return false;
+        }
+        if (staged == kStageSize) {
+            sum.update(stage, staged);
+            staged = 0;
+        }
+        stage[staged++] = static_cast<char>(c);
+        b = static_cast<uint8_t>(c);
+        return true;
+    }
+
+    // Appends n elements to buf. The buffer grows a block at a time as the
+    // bytes arrive, so a corrupt length fails once the stream runs out
+    // instead of allocating whatever the length asked for.
+    template<typename Buf>
+    bool append(Buf& buf, uint64_t n) {
+        using E = typename Buf::value_type;
+        constexpr size_t kBlock = kStageSize / sizeof(E);
+        while (n > 0) {
+            size_t count = n < kBlock ? static_cast<size_t>(n) : kBlock;
+            size_t at = buf.size();
+            buf.resize(at + count);
+            if (!get(&buf[at], count * sizeof(E))) {
+                return false;
+            }
+            n -= count;
+        }
+        return true;
+    }
+
+    bool getVarint(uint64_t& v) {
+        v = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            uint8_t b;
+            if (!getByte(b)) {
+                return false;
+            }
+            v |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if (!(b & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Checksum of everything read so far
+    uint64_t checksum() {
+        sum.update(stage, staged);
+        staged = 0;
+        return sum.value();
+    }
+};
+
+#endif // VALUE_CODEC_H
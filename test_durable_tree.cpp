@@ -0,0 +1,235 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <thread>
+#include <fstream>
+#include <cassert>
+#include <cstdlib>
+#include "radix/durable_tree.hpp"
+
+// A DurableTree logs every write before returning it and recovers its
+// contents from the snapshot and logs when the directory is opened again.
+// These tests reopen trees in temporary directories and compare them with
+// a map of the writes that were acknowledged.
+
+using Durable = DurableTree<std::string, std::string>;
+
+std::string tempDir() {
+    char name[] = "/tmp/test_durable_tree.XXXXXX";
+    char* dir = mkdtemp(name);
+    assert(dir);
+    return dir;
+}
+
+void removeDir(const std::string& dir) {
+    std::string cmd = "rm -rf '" + dir + "'";
+    int status = std::system(cmd.c_str());
+    (void)status;
+}
+
+void checkContents(Durable& tree, const std::map<std::string, std::string>& expected) {
+    assert(tree.len() == static_cast<int>(expected.size()));
+    tree.read([&](const Tree<std::string, std::string>& t) {
+        auto it = t.iterator();
+        auto exp = expected.begin();
+        for (auto res = it.next(); res.found; res = it.next(), ++exp) {
+            assert(exp != expected.end() && res.key == exp->first && res.val == exp->second);
+        }
+        assert(exp == expected.end());
+        return 0;
+    });
+}
+
+// Applies a random mix of writes to the tree and to expected
+void randomWrites(Durable& tree, std::map<std::string, std::string>& expected, std::mt19937& rng, int count) {
+    for (int i = 0; i < count; i++) {
+        std::string key = "k/" + std::to_string(rng() % 500);
+        int op = rng() % 10;
+        if (op < 7) {
+            std::string val = "v" + std::to_string(rng()) + std::string(rng() % 50, 'x');
+            assert(tree.insert(key, val));
+            expected[key] = val;
+        } else if (op < 9) {
+            assert(tree.del(key));
+            expected.erase(key);
+        } else {
+            std::string prefix = key.substr(0, 3);
+            assert(tree.deletePrefix(prefix));
+            expected.erase(expected.lower_bound(prefix), expected.lower_bound(prefix + "\xff"));
+        }
+    }
+}
+
+void testReopen() {
+    std::cout << "Testing recovery from the log..." << std::endl;
+
+    auto dir = tempDir();
+    std::mt19937 rng(19);
+    std::map<std::string, std::string> expected;
+    {
+        auto tree = Durable::open(dir);
+        assert(tree && tree->len() == 0);
+        randomWrites(*tree, expected, rng, 3000);
+        std::vector<std::pair<std::string, std::string>> batch;
+        for (int i = 0; i < 100; i++) {
+            batch.push_back({"batch/" + std::to_string(i), std::to_string(i)});
+            expected["batch/" + std::to_string(i)] = std::to_string(i);
+        }
+        assert(tree->insertBatch(batch));
+        checkContents(*tree, expected);
+    }
+    {
+        auto tree = Durable::open(dir);
+        assert(tree);
+        checkContents(*tree, expected);
+
+        // Writes after a recovery go to a new log and survive another one
+        randomWrites(*tree, expected, rng, 500);
+    }
+    auto tree = Durable::open(dir);
+    assert(tree);
+    checkContents(*tree, expected);
+    removeDir(dir);
+
+    std::cout << "✓ reopen test passed!" << std::endl;
+}
+
+void testCheckpoints() {
+    std::cout << "Testing snapshots and log truncation..." << std::endl;
+
+    auto dir = tempDir();
+    std::mt19937 rng(23);
+    std::map<std::string, std::string> expected;
+    Durable::Options options;
+    options.checkpointBytes = 16 * 1024;
+    {
+        auto tree = Durable::open(dir, options);
+        assert(tree);
+        randomWrites(*tree, expected, rng, 5000);
+        assert(tree->checkpoint());
+        randomWrites(*tree, expected, rng, 50);
+    }
+    // Checkpoints delete the logs they cover, leaving the current one and
+    // the few writes since
+    std::ifstream snapshot(dir + "/snapshot");
+    assert(snapshot);
+    std::ifstream oldLog(dir + "/wal.1");
+    assert(!oldLog);
+
+    auto tree = Durable::open(dir, options);
+    assert(tree);
+    checkContents(*tree, expected);
+    removeDir(dir);
+
+    std::cout << "✓ checkpoint test passed!" << std::endl;
+}
+
+void testTornTail() {
+    std::cout << "Testing a log cut short by a crash..." << std::endl;
+
+    auto dir = tempDir();
+    std::map<std::string, std::string> expected;
+    {
+        auto tree = Durable::open(dir);
+        assert(tree);
+        for (int i = 0; i < 100; i++) {
+            tree->insert("key/" + std::to_string(i), "value");
+            expected["key/" + std::to_string(i)] = "value";
+        }
+    }
+    // Half a frame, as if the process died mid-write, then garbage
+    {
+        std::ofstream log(dir + "/wal.1", std::ios::binary | std::ios::app);
+        uint32_t length = 1000;
+        log.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        log.write("\x01\x02\x03", 3);
+    }
+    {
+        auto tree = Durable::open(dir);
+        assert(tree);
+        checkContents(*tree, expected);
+        tree->insert("after", "crash");
+        expected["after"] = "crash";
+    }
+    auto tree = Durable::open(dir);
+    assert(tree);
+    checkContents(*tree, expected);
+    removeDir(dir);
+
+    std::cout << "✓ torn tail test passed!" << std::endl;
+}
+
+void testGroupCommit() {
+    std::cout << "Testing concurrent writers sharing syncs..." << std::endl;
+
+    auto dir = tempDir();
+    const int threads = 8;
+    const int perThread = 500;
+    Durable::Options options;
+    options.checkpointBytes = 64 * 1024;
+    {
+        auto tree = Durable::open(dir, options);
+        assert(tree);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([&tree, t] {
+                for (int i = 0; i < perThread; i++) {
+                    bool ok = tree->insert("t" + std::to_string(t) + "/" + std::to_string(i), std::to_string(i));
+                    assert(ok);
+                    (void)ok;
+                }
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+        assert(tree->ok() && tree->len() == threads * perThread);
+        std::cout << "  " << threads * perThread << " writes in " << tree->syncCount() << " syncs" << std::endl;
+        assert(tree->syncCount() <= static_cast<uint64_t>(threads * perThread));
+    }
+    auto tree = Durable::open(dir, options);
+    assert(tree && tree->len() == threads * perThread);
+    for (int t = 0; t < threads; t++) {
+        for (int i = 0; i < perThread; i++) {
+            assert(tree->Get("t" + std::to_string(t) + "/" + std::to_string(i)) == std::to_string(i));
+        }
+    }
+    removeDir(dir);
+
+    std::cout << "✓ group commit test passed!" << std::endl;
+}
+
+void testIntValues() {
+    std::cout << "Testing a durable tree of ints..." << std::endl;
+
+    auto dir = tempDir();
+    {
+        auto tree = DurableTree<std::string, int>::open(dir);
+        assert(tree);
+        tree->insert("", -1);
+        tree->insert("a", 1);
+        tree->insert("ab", 2);
+        tree->del("a");
+    }
+    auto tree = DurableTree<std::string, int>::open(dir);
+    assert(tree && tree->len() == 2);
+    assert(tree->Get("") == -1 && !tree->Get("a") && tree->Get("ab") == 2);
+    removeDir(dir);
+
+    std::cout << "✓ int values test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "Running durable tree tests..." << std::endl;
+
+    testReopen();
+    testCheckpoints();
+    testTornTail();
+    testGroupCommit();
+    testIntValues();
+
+    std::cout << "\nAll durable tree tests passed!" << std::endl;
+    return 0;
+}
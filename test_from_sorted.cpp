@@ -0,0 +1,112 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <cassert>
+#include "radix/tree.hpp"
+#include "test_keys.hpp"
+
+void testBasicLoad() {
+    std::cout << "Testing fromSorted on a small key set..." << std::endl;
+    
+    std::map<std::string, int> expected = {
+        {"", 0}, {"a", 1}, {"ab", 2}, {"abc", 3}, {"abd", 4}, {"b", 5},
+        {"romane", 6}, {"romanus", 7}, {"romulus", 8}, {"rubens", 9},
+        {"ruber", 10}, {"rubicon", 11}, {"rubicundus", 12}
+    };
+    auto tree = Tree<std::string, int>::fromSorted(expected);
+    checkTree(tree, expected);
+    
+    auto longest = tree.LongestPrefix(std::string("rubiconic"));
+    assert(longest.found && longest.key == "rubicon");
+    assert(tree.findMatchingPrefixes(std::string("abcd")).size() == 4);
+    
+    std::cout << "✓ basic load test passed!" << std::endl;
+}
+
+void testDuplicatesAndEmpty() {
+    std::cout << "Testing fromSorted with duplicates and empty input..." << std::endl;
+    
+    std::vector<std::pair<std::string, int>> empty;
+    auto emptyTree = Tree<std::string, int>::fromSorted(empty.begin(), empty.end());
+    assert(emptyTree.len() == 0);
+    assert(!emptyTree.iterator().next().found);
+    
+    std::vector<std::pair<std::string, int>> dups = {{"a", 1}, {"a", 2}, {"b", 3}, {"b", 4}, {"b", 5}};
+    auto tree = Tree<std::string, int>::fromSorted(dups.begin(), dups.end());
+    checkTree(tree, std::map<std::string, int>{{"a", 2}, {"b", 5}});
+    
+    std::cout << "✓ duplicates and empty input test passed!" << std::endl;
+}
+
+void testUnsortedInput() {
+    std::cout << "Testing fromSorted with unsorted input..." << std::endl;
+    
+    std::vector<std::pair<std::string, int>> unsorted = {{"foo", 1}, {"bar", 2}, {"foobar", 3}, {"baz", 4}};
+    auto tree = Tree<std::string, int>::fromSorted(unsorted.begin(), unsorted.end());
+    checkTree(tree, std::map<std::string, int>(unsorted.begin(), unsorted.end()));
+    
+    std::cout << "✓ unsorted input test passed!" << std::endl;
+}
+
+void testRandomLoadThenMutate() {
+    std::cout << "Testing fromSorted against insert on random keys..." << std::endl;
+    
+    std::mt19937 rng(7);
+    std::map<std::string, int> expected;
+    for (int i = 0; i < 20000; i++) {
+        std::string key;
+        int len = rng() % 24;
+        for (int j = 0; j < len; j++) {
+            key.push_back(static_cast<char>("abc\x80\xff"[rng() % 5]));
+        }
+        expected[key] = i;
+    }
+    auto tree = Tree<std::string, int>::fromSorted(expected);
+    checkTree(tree, expected);
+    
+    // A bulk-loaded tree takes further updates like any other
+    for (int i = 0; i < 5000; i++) {
+        std::string key;
+        int len = rng() % 24;
+        for (int j = 0; j < len; j++) {
+            key.push_back(static_cast<char>("abc\x80\xff"[rng() % 5]));
+        }
+        if (i % 2) {
+            tree.insert(key, -i);
+            expected[key] = -i;
+        } else {
+            tree.del(key);
+            expected.erase(key);
+        }
+    }
+    checkTree(tree, expected);
+    
+    std::cout << "✓ random load and mutate test passed!" << std::endl;
+}
+
+void testByteKeys() {
+    std::cout << "Testing fromSorted with byte vector keys..." << std::endl;
+    
+    std::map<std::vector<uint8_t>, std::string> expected = {
+        {{0x00}, "a"}, {{0x00, 0x01}, "b"}, {{0x7f, 0x80}, "c"}, {{0x80}, "d"}, {{0xff, 0xff}, "e"}
+    };
+    auto tree = Tree<std::vector<uint8_t>, std::string>::fromSorted(expected);
+    checkTree(tree, expected);
+    
+    std::cout << "✓ byte vector keys test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "Running fromSorted tests..." << std::endl;
+    
+    testBasicLoad();
+    testDuplicatesAndEmpty();
+    testUnsortedInput();
+    testRandomLoadThenMutate();
+    testByteKeys();
+    
+    std::cout << "\nAll fromSorted tests passed!" << std::endl;
+    return 0;
+}
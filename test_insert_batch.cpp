@@ -0,0 +1,127 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <cassert>
+#include "radix/tree.hpp"
+#include "test_keys.hpp"
+
+// insertBatch keeps the path to the previous key open and settles min/max
+// leaves and counts only when it moves past a node. These tests check every
+// node and the leaf list after batches against a std::map.
+
+// Keys that share prefixes at many depths, like paths in a log
+std::string randomPath(std::mt19937& rng) {
+    std::string key;
+    int parts = 1 + rng() % 4;
+    for (int i = 0; i < parts; i++) {
+        key += "/";
+        key += "abcd"[rng() % 4];
+        if (rng() % 3 == 0) {
+            key += "-segment";
+        }
+    }
+    if (rng() % 4 == 0) {
+        key.pop_back();
+    }
+    return key;
+}
+
+void testBatchesAgainstMap() {
+    std::cout << "Testing batches into a populated tree..." << std::endl;
+
+    std::mt19937 rng(16);
+    Tree<std::string, int> tree;
+    Map expected;
+    fillRandom(tree, expected, rng, randomPath, 500);
+
+    for (int round = 0; round < 20; round++) {
+        std::vector<std::pair<std::string, int>> batch;
+        int size = rng() % 400;
+        for (int i = 0; i < size; i++) {
+            batch.emplace_back(randomPath(rng), round * 1000 + i);
+        }
+        // Every other batch arrives sorted; repeats keep the last value
+        if (round % 2) {
+            std::stable_sort(batch.begin(), batch.end(), [](const auto& a, const auto& b) {
+                return a.first < b.first;
+            });
+        }
+        int added = 0;
+        for (const auto& [key, val] : batch) {
+            added += expected.count(key) ? 0 : 1;
+            expected[key] = val;
+        }
+        assert(tree.insertBatch(batch) == added);
+        checkTree(tree, expected);
+    }
+
+    std::cout << "✓ batches test passed!" << std::endl;
+}
+
+void testEdgeCases() {
+    std::cout << "Testing empty keys, splits and empty batches..." << std::endl;
+
+    Tree<std::string, int> tree;
+    Map expected;
+    assert(tree.insertBatch(std::vector<std::pair<std::string, int>>{}) == 0);
+    checkTree(tree, expected);
+
+    // Prefixes of later keys, splits inside long prefixes and the empty key
+    std::vector<std::pair<std::string, int>> batch = {
+        {"", 1}, {"a", 2}, {"abcdefghijklmnopqrstuvwxyz", 3}, {"abcdefghijklmnopqrstuvwxyz-more", 4},
+        {"abcdefghijklmNOP", 5}, {"abcdefghijklmnopq", 6}, {"b", 7}, {"abc", 8}, {"a", 9},
+    };
+    assert(tree.insertBatch(batch) == 8);
+    for (const auto& [key, val] : batch) {
+        expected[key] = val;
+    }
+    checkTree(tree, expected);
+
+    // A batch that goes below every existing key and splits the root's
+    // only long edge
+    Tree<std::string, int> single;
+    single.insert("zzzzzzzzzzzzzzzz", 0);
+    std::vector<std::pair<std::string, int>> before = {{"aaa", 1}, {"zzzz", 2}, {"zzzzzzzzzzzzzzzzz", 3}};
+    assert(single.insertBatch(before) == 3);
+    checkTree(single, Map{{"aaa", 1}, {"zzzz", 2}, {"zzzzzzzzzzzzzzzz", 0}, {"zzzzzzzzzzzzzzzzz", 3}});
+
+    std::cout << "✓ edge cases test passed!" << std::endl;
+}
+
+void testSnapshotsKeepContents() {
+    std::cout << "Testing snapshots taken before a batch..." << std::endl;
+
+    std::mt19937 rng(61);
+    Tree<std::string, int> tree;
+    Map before;
+    fillRandom(tree, before, rng, randomPath, 2000);
+    auto snapshot = tree;
+
+    std::vector<std::pair<std::string, int>> batch;
+    Map after = before;
+    for (int i = 0; i < 2000; i++) {
+        auto key = randomPath(rng);
+        batch.emplace_back(key, -i);
+        after[key] = -i;
+    }
+    tree.insertBatch(batch);
+
+    checkTree(tree, after);
+    checkTree(snapshot, before);
+    checkTree(tree, after);
+
+    std::cout << "✓ snapshots test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "Running insertBatch tests..." << std::endl;
+
+    testBatchesAgainstMap();
+    testEdgeCases();
+    testSnapshotsKeepContents();
+
+    std::cout << "\nAll insertBatch tests passed!" << std::endl;
+    return 0;
+}
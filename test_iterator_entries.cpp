@@ -0,0 +1,227 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <iterator>
+#include <algorithm>
+#include <cassert>
+#include "radix/tree.hpp"
+
+// Iterator and ReverseIterator are bidirectional iterators whose elements
+// refer to the leaves instead of copying them, and nextLeaf/previousLeaf
+// are the copy-free forms of next/previous. These tests run STL algorithms
+// over trees and seeked iterators and compare with a std::map.
+
+using Map = std::map<std::string, int>;
+
+std::string str(KeyView<char> key) {
+    return std::string(key.begin(), key.end());
+}
+
+Tree<std::string, int> randomTree(Map& expected) {
+    std::mt19937 rng(22);
+    Tree<std::string, int> tree;
+    for (int i = 0; i < 3000; i++) {
+        std::string key;
+        int len = 1 + rng() % 8;
+        for (int j = 0; j < len; j++) {
+            key.push_back("ab/\xff"[rng() % 4]);
+        }
+        tree.insert(key, i);
+        expected[key] = i;
+    }
+    return tree;
+}
+
+void testRangeFor() {
+    std::cout << "Testing range-for and STL algorithms..." << std::endl;
+
+    Map expected;
+    auto tree = randomTree(expected);
+
+    auto exp = expected.begin();
+    for (const auto& [key, val] : tree) {
+        assert(exp != expected.end() && key == exp->first && val == exp->second);
+        ++exp;
+    }
+    assert(exp == expected.end());
+
+    // Entries refer to the tree's own value
+    auto first = *tree.begin();
+    assert(&first.val == &tree.begin().nextLeaf()->val);
+
+    assert(std::distance(tree.begin(), tree.end()) == static_cast<long>(expected.size()));
+    auto found = std::find_if(tree.begin(), tree.end(), [](const auto& e) { return e.val == 1234; });
+    auto expFound = std::find_if(expected.begin(), expected.end(), [](const auto& e) { return e.second == 1234; });
+    assert((found == tree.end()) == (expFound == expected.end()));
+    if (found != tree.end()) {
+        assert((*found).key == expFound->first);
+    }
+    assert(std::count_if(tree.begin(), tree.end(), [](const auto& e) { return e.key.size() == 3; }) ==
+           std::count_if(expected.begin(), expected.end(), [](const auto& e) { return e.first.size() == 3; }));
+
+    // Backwards, through --, std::reverse_iterator and rbegin
+    auto it = tree.end();
+    auto rexp = expected.rbegin();
+    while (it != tree.begin()) {
+        --it;
+        assert(str((*it).key) == rexp->first);
+        ++rexp;
+    }
+    assert(rexp == expected.rend());
+    assert(std::equal(std::make_reverse_iterator(tree.end()), std::make_reverse_iterator(tree.begin()),
+                      expected.rbegin(), expected.rend(),
+                      [](const auto& e, const auto& m) { return e.key == m.first && e.val == m.second; }));
+    assert(std::equal(tree.rbegin(), tree.rend(), expected.rbegin(), expected.rend(),
+                      [](const auto& e, const auto& m) { return e.key == m.first; }));
+    assert(str((*std::prev(tree.rend())).key) == expected.begin()->first);
+
+    std::cout << "✓ range-for test passed!" << std::endl;
+}
+
+void testSeekedRanges() {
+    std::cout << "Testing seeked iterators as ranges..." << std::endl;
+
+    Map expected;
+    auto tree = randomTree(expected);
+
+    // A prefix: the range ends with the prefix's keys
+    auto it = tree.iterator();
+    it.seekPrefix(std::string("ab"));
+    auto exp = expected.lower_bound("ab");
+    for (const auto& [key, val] : it) {
+        assert(str(key) == exp->first && val == exp->second);
+        ++exp;
+    }
+    assert(exp == expected.lower_bound("ac"));
+    assert(std::distance(it.begin(), it.end()) == tree.countPrefix(std::string("ab")));
+
+    // From a lower bound back to the start of the prefix
+    it.seekLowerBound(std::string("ab/"));
+    auto back = it;
+    std::vector<std::string> before;
+    auto prefixStart = tree.iterator();
+    prefixStart.seekPrefix(std::string("ab"));
+    while (back != prefixStart) {
+        --back;
+        before.push_back(str((*back).key));
+    }
+    assert(static_cast<int>(before.size()) == tree.rank(std::string("ab/")) - tree.rank(std::string("ab")));
+
+    auto rit = tree.reverseIterator();
+    rit.seekReverseLowerBound(std::string("b"));
+    auto rexp = std::make_reverse_iterator(expected.upper_bound("b"));
+    for (const auto& entry : rit) {
+        assert(entry.key == rexp->first);
+        ++rexp;
+    }
+    assert(rexp == expected.rend());
+
+    std::cout << "✓ seeked range test passed!" << std::endl;
+}
+
+void testLeafSteps() {
+    std::cout << "Testing nextLeaf and previousLeaf..." << std::endl;
+
+    Map expected;
+    auto tree = randomTree(expected);
+
+    auto it = tree.iterator();
+    auto exp = expected.begin();
+    while (auto leaf = it.nextLeaf()) {
+        assert(leaf->key == exp->first && leaf->val == exp->second);
+        ++exp;
+    }
+    assert(exp == expected.end() && !it.next().found);
+
+    auto rit = tree.reverseIterator();
+    auto rexp = expected.rbegin();
+    while (auto leaf = rit.previousLeaf()) {
+        assert(leaf->key == rexp->first);
+        ++rexp;
+    }
+    assert(rexp == expected.rend());
+
+    auto pit = tree.prefixIterator(std::string("ab/ab"));
+    std::vector<std::string> prefixes;
+    while (auto leaf = pit.nextLeaf()) {
+        prefixes.push_back(leaf->getKey());
+    }
+    std::vector<std::string> expectedPrefixes;
+    for (size_t n = 0; n <= 5; n++) {
+        if (expected.count(std::string("ab/ab").substr(0, n))) {
+            expectedPrefixes.push_back(std::string("ab/ab").substr(0, n));
+        }
+    }
+    assert(prefixes == expectedPrefixes);
+
+    Tree<std::string, int> empty;
+    assert(empty.begin() == empty.end() && empty.rbegin() == empty.rend());
+    assert(!empty.iterator().nextLeaf());
+
+    std::cout << "✓ leaf step test passed!" << std::endl;
+}
+
+void testSnapshots() {
+    std::cout << "Testing iterators over older snapshots..." << std::endl;
+
+    Map expected;
+    auto tree = randomTree(expected);
+    auto old = tree;
+    for (const auto& entry : expected) {
+        if (entry.second % 3 == 0) {
+            tree.del(entry.first);
+        }
+    }
+    tree.insert("ab/new", -1);
+
+    // The snapshot no longer owns the leaf list, so its iterators step
+    // through its nodes, forwards and backwards
+    assert(std::equal(old.begin(), old.end(), expected.begin(), expected.end(),
+                      [](const auto& e, const auto& m) { return e.key == m.first && e.val == m.second; }));
+    assert(std::equal(old.rbegin(), old.rend(), expected.rbegin(), expected.rend(),
+                      [](const auto& e, const auto& m) { return e.key == m.first; }));
+    auto it = old.end();
+    auto rexp = expected.rbegin();
+    while (it != old.begin()) {
+        --it;
+        assert(str((*it).key) == rexp->first);
+        ++rexp;
+    }
+    assert(rexp == expected.rend());
+
+    auto pit = old.iterator();
+    pit.seekPrefix(std::string("ab"));
+    pit.seekLowerBound(std::string("ab/"));
+    auto exp = expected.lower_bound("ab/");
+    for (const auto& [key, val] : pit) {
+        assert(key == exp->first && val == exp->second);
+        ++exp;
+    }
+    assert(exp == expected.lower_bound("ac"));
+
+    auto rit = old.reverseIterator();
+    rit.seekPrefix(std::string("b"));
+    rit.seekReverseLowerBound(std::string("b/"));
+    auto rexpFrom = std::make_reverse_iterator(expected.upper_bound("b/"));
+    for (const auto& entry : rit) {
+        assert(entry.key == rexpFrom->first);
+        ++rexpFrom;
+    }
+    assert(rexpFrom == std::make_reverse_iterator(expected.lower_bound("b")));
+
+    std::cout << "✓ snapshot test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "Running iterator entry tests..." << std::endl;
+
+    testRangeFor();
+    testSeekedRanges();
+    testLeafSteps();
+    testSnapshots();
+
+    std::cout << "\nAll iterator entry tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cassert>
+#include <cstring>
+#include "radix/tree.hpp"
+
+void testStringViewLookups() {
+    std::cout << "Testing string_view lookups..." << std::endl;
+    
+    Tree<std::string, std::string> tree;
+    tree.insert("", "empty");
+    tree.insert("foo", "a");
+    tree.insert("foo/bar", "b");
+    tree.insert("foobar", "c");
+    
+    // Query straight out of a larger buffer without building a std::string
+    const char* packet = "GET foo/bar/baz HTTP/1.1";
+    std::string_view path(packet + 4, std::strlen("foo/bar/baz"));
+    
+    assert(!tree.Get(path).has_value());
+    assert(tree.Get(path.substr(0, 7)) == "b");
+    assert(tree.Get(std::string_view("foobar")) == "c");
+    
+    auto longest = tree.LongestPrefix(path);
+    assert(longest.found && longest.key == "foo/bar" && longest.val == "b");
+    
+    auto prefixes = tree.findMatchingPrefixes(path);
+    assert(prefixes.size() == 3);
+    assert(prefixes[0].first == "" && prefixes[1].first == "foo" && prefixes[2].first == "foo/bar");
+    
+    auto prefixIter = tree.prefixIterator(path);
+    int count = 0;
+    while (prefixIter.next().found) {
+        count++;
+    }
+    assert(count == 3);
+    
+    auto iter = tree.iterator();
+    iter.seekPrefix(std::string_view("foo/"));
+    auto res = iter.next();
+    assert(res.found && res.key == "foo/bar");
+    assert(!iter.next().found);
+    
+    auto rit = ReverseIterator<std::string, std::string>(tree.getRoot());
+    rit.seekPrefix(std::string_view("foo"));
+    res = rit.previous();
+    assert(res.found && res.key == "foobar");
+    
+    std::cout << "✓ string_view lookups test passed!" << std::endl;
+}
+
+void testRawBufferLookups() {
+    std::cout << "Testing raw buffer lookups..." << std::endl;
+    
+    Tree<std::vector<uint8_t>, std::string> tree;
+    tree.insert({1, 2, 3}, "one-two-three");
+    tree.insert({1, 2}, "one-two");
+    
+    // A slice of a receive buffer, viewed in place
+    uint8_t buffer[] = {9, 9, 1, 2, 3, 4};
+    KeyViewOf<std::vector<uint8_t>> slice(buffer + 2, 3);
+    
+    assert(tree.Get(slice) == "one-two-three");
+    assert(tree.Get(slice.substr(1)) == std::nullopt);
+    
+    auto longest = tree.LongestPrefix(KeyViewOf<std::vector<uint8_t>>(buffer + 2, 4));
+    assert(longest.found && longest.val == "one-two-three");
+    
+    auto prefixes = tree.findMatchingPrefixes(slice);
+    assert(prefixes.size() == 2);
+    
+    std::cout << "✓ raw buffer lookups test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "Running key view lookup tests..." << std::endl;
+    
+    testStringViewLookups();
+    testRawBufferLookups();
+    
+    std::cout << "\nAll key view lookup tests passed!" << std::endl;
+    return 0;
+}
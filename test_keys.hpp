@@ -0,0 +1,133 @@
+#ifndef TEST_KEYS_H
+#define TEST_KEYS_H
+
+#include <cassert>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "radix/tree.hpp"
+
+// Random keys, std::map/std::set answers and whole-tree checks shared by
+// the tests that check a tree against the standard containers.
+
+using Map = std::map<std::string, int>;
+using Visited = std::vector<std::pair<std::string, int>>;
+
+// KeyGen draws keys from a small alphabet, so they share prefixes at every
+// depth. With spill set, one key in eight gets a long suffix that does not
+// fit in a node's inline prefix.
+struct KeyGen {
+    std::string alphabet;
+    int minLen;
+    int maxLen;  // lengths are drawn from [minLen, maxLen)
+    bool spill = false;
+
+    std::string operator()(std::mt19937& rng) const {
+        std::string key;
+        int len = minLen + static_cast<int>(rng() % (maxLen - minLen));
+        for (int i = 0; i < len; i++) {
+            key.push_back(alphabet[rng() % alphabet.size()]);
+        }
+        if (spill && rng() % 8 == 0) {
+            key += "-long-enough-to-spill-the-prefix";
+        }
+        return key;
+    }
+};
+
+// Inserts count keys from gen into tree and expected, each with the index
+// it was drawn at as its value
+template<typename Tree, typename Gen>
+void fillRandom(Tree& tree, Map& expected, std::mt19937& rng, const Gen& gen, int count) {
+    for (int i = 0; i < count; i++) {
+        auto key = gen(rng);
+        tree.insert(key, i);
+        expected[key] = i;
+    }
+}
+
+template<typename Tree, typename Gen>
+void fillRandom(Tree& tree, std::set<std::string>& expected, std::mt19937& rng, const Gen& gen, int count) {
+    for (int i = 0; i < count; i++) {
+        auto key = gen(rng);
+        tree.insert(key, i);
+        expected.insert(key);
+    }
+}
+
+// Entries of expected whose keys start with prefix, in order
+inline Visited entriesUnder(const Map& expected, const std::string& prefix) {
+    Visited under;
+    for (auto it = expected.lower_bound(prefix); it != expected.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+        under.push_back(*it);
+    }
+    return under;
+}
+
+// Entries of expected whose keys are prefixes of path, shortest first
+inline Visited entriesAlong(const Map& expected, const std::string& path) {
+    Visited along;
+    for (size_t n = 0; n <= path.size(); n++) {
+        auto it = expected.find(path.substr(0, n));
+        if (it != expected.end()) {
+            along.push_back(*it);
+        }
+    }
+    return along;
+}
+
+// Returns true if every node's count and min/max leaves match its children
+template<typename K, typename T>
+bool checkNode(const Node<K, T>* n) {
+    int count = n->leaf ? 1 : 0;
+    const LeafNode<K, T>* minLeaf = n->leaf;
+    const LeafNode<K, T>* maxLeaf = n->leaf;
+    for (const auto& edge : n->edges) {
+        if (!checkNode(edge.node)) {
+            return false;
+        }
+        count += edge.node->leaves_in_subtree;
+        if (!minLeaf) {
+            minLeaf = edge.node->minLeaf;
+        }
+        maxLeaf = edge.node->maxLeaf;
+    }
+    return count == n->leaves_in_subtree && minLeaf == n->minLeaf && maxLeaf == n->maxLeaf;
+}
+
+// Checks every node, then that the tree holds exactly the entries of
+// expected, through forward and reverse iteration, GetAtIndex and Get
+template<typename K, typename T>
+void checkTree(const Tree<K, T>& tree, const std::map<K, T>& expected) {
+    assert(checkNode(tree.getRoot()));
+    assert(tree.len() == static_cast<int>(expected.size()));
+    assert(tree.GetLeavesInSubtree() == static_cast<int>(expected.size()));
+
+    auto it = tree.iterator();
+    auto exp = expected.begin();
+    for (auto res = it.next(); res.found; res = it.next(), ++exp) {
+        assert(exp != expected.end());
+        assert(res.key == exp->first && res.val == exp->second);
+    }
+    assert(exp == expected.end());
+
+    auto rit = tree.reverseIterator();
+    auto rexp = expected.rbegin();
+    for (auto res = rit.previous(); res.found; res = rit.previous(), ++rexp) {
+        assert(rexp != expected.rend());
+        assert(res.key == rexp->first && res.val == rexp->second);
+    }
+    assert(rexp == expected.rend());
+
+    int index = 0;
+    for (const auto& [key, val] : expected) {
+        auto [k, v, found] = tree.GetAtIndex(index++);
+        assert(found && k == key && v == val);
+        assert(tree.Get(key) == val);
+    }
+}
+
+#endif // TEST_KEYS_H
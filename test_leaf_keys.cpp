@@ -0,0 +1,122 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cassert>
+#include "radix/tree.hpp"
+
+// Leaves keep their keys in the tree's key buffer rather than owning a copy.
+// These tests check that keys read back intact through every path that
+// returns them, including after deletes recycle buffer space.
+
+void testKeysReadBack() {
+    std::cout << "Testing keys read back from the key buffer..." << std::endl;
+    
+    Tree<std::string, int> tree;
+    std::map<std::string, int> expected;
+    std::vector<std::string> keys = {"", "a", "ab", "abc", "b", "ba", "romane", "romanus", "romulus",
+                                     "rubens", "ruber", "rubicon", "rubicundus"};
+    for (size_t i = 0; i < keys.size(); i++) {
+        tree.insert(keys[i], static_cast<int>(i));
+        expected[keys[i]] = static_cast<int>(i);
+    }
+    
+    auto it = tree.iterator();
+    auto exp = expected.begin();
+    for (auto res = it.next(); res.found; res = it.next(), ++exp) {
+        assert(exp != expected.end());
+        assert(res.key == exp->first && res.val == exp->second);
+    }
+    assert(exp == expected.end());
+    
+    for (int i = 0; i < tree.len(); i++) {
+        auto [key, val, found] = tree.GetAtIndex(i);
+        assert(found && expected[key] == val);
+    }
+    
+    auto longest = tree.LongestPrefix(std::string("rubiconic"));
+    assert(longest.found && longest.key == "rubicon");
+    
+    auto prefixes = tree.findMatchingPrefixes(std::string("abcd"));
+    assert(prefixes.size() == 4);
+    assert(prefixes[3].first == "abc");
+    
+    std::cout << "✓ keys read back test passed!" << std::endl;
+}
+
+void testKeysSurviveChurn() {
+    std::cout << "Testing keys across delete and re-insert..." << std::endl;
+    
+    Tree<std::string, int> tree;
+    std::map<std::string, int> expected;
+    
+    // Fixed-width keys reuse each other's space once deleted; a few long
+    // keys go through the oversized path of the buffer
+    for (int i = 0; i < 5000; i++) {
+        std::string key = "key-" + std::to_string(100000 + i);
+        if (i % 500 == 0) {
+            key += std::string(20000, static_cast<char>('a' + i % 26));
+        }
+        tree.insert(key, i);
+        expected[key] = i;
+    }
+    for (int round = 0; round < 3; round++) {
+        for (auto it = expected.begin(); it != expected.end();) {
+            if (it->second % 3 == round) {
+                tree.del(it->first);
+                it = expected.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        for (int i = 0; i < 1000; i++) {
+            std::string key = "new-" + std::to_string(round) + "-" + std::to_string(100000 + i);
+            tree.insert(key, -i);
+            expected[key] = -i;
+        }
+    }
+    
+    assert(tree.len() == static_cast<int>(expected.size()));
+    auto it = tree.iterator();
+    auto exp = expected.begin();
+    for (auto res = it.next(); res.found; res = it.next(), ++exp) {
+        assert(exp != expected.end());
+        assert(res.key == exp->first && res.val == exp->second);
+    }
+    assert(exp == expected.end());
+    
+    std::cout << "✓ churn test passed!" << std::endl;
+}
+
+void testByteKeys() {
+    std::cout << "Testing byte vector keys..." << std::endl;
+    
+    Tree<std::vector<uint8_t>, std::string> tree;
+    tree.insert({0, 1, 2}, "a");
+    tree.insert({0, 1}, "b");
+    tree.insert({0xff}, "c");
+    tree.del({0, 1, 2});
+    tree.insert({7, 7, 7}, "d");
+    
+    auto it = tree.iterator();
+    auto res = it.next();
+    assert(res.found && res.key == std::vector<uint8_t>({0, 1}) && res.val == "b");
+    res = it.next();
+    assert(res.found && res.key == std::vector<uint8_t>({7, 7, 7}) && res.val == "d");
+    res = it.next();
+    assert(res.found && res.key == std::vector<uint8_t>({0xff}) && res.val == "c");
+    assert(!it.next().found);
+    
+    std::cout << "✓ byte vector keys test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "Running leaf key tests..." << std::endl;
+    
+    testKeysReadBack();
+    testKeysSurviveChurn();
+    testByteKeys();
+    
+    std::cout << "\nAll leaf key tests passed!" << std::endl;
+    return 0;
+}
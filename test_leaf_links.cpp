@@ -0,0 +1,103 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <cassert>
+#include "radix/tree.hpp"
+#include "test_keys.hpp"
+
+// Insert and delete maintain the leaf list, leaves_in_subtree and
+// minLeaf/maxLeaf incrementally along the path. These tests check every node
+// against a full recount after mixed updates.
+
+// Checks the leaf list in both directions against expected
+template<typename K, typename T>
+void checkLeafList(const Tree<K, T>& tree, const std::map<K, T>& expected) {
+    assert(checkNode(tree.getRoot()));
+    assert(tree.len() == static_cast<int>(expected.size()));
+    
+    const LeafNode<K, T>* leaf = tree.getRoot()->minLeaf;
+    const LeafNode<K, T>* last = nullptr;
+    for (const auto& [key, val] : expected) {
+        assert(leaf && leaf->getKey() == key && leaf->val == val);
+        assert(leaf->prevLeaf == last);
+        last = leaf;
+        leaf = leaf->nextLeaf;
+    }
+    assert(leaf == nullptr);
+    assert(tree.getRoot()->maxLeaf == last);
+}
+
+void testHighFanout() {
+    std::cout << "Testing leaf links under a wide root..." << std::endl;
+    
+    std::mt19937 rng(21);
+    Tree<std::string, int> tree;
+    std::map<std::string, int> expected;
+    for (int i = 0; i < 20000; i++) {
+        std::string key;
+        int len = 1 + rng() % 4;
+        for (int j = 0; j < len; j++) {
+            key.push_back(static_cast<char>(rng() % 256));
+        }
+        if (rng() % 3) {
+            tree.insert(key, i);
+            expected[key] = i;
+        } else {
+            tree.del(key);
+            expected.erase(key);
+        }
+        if (i % 1000 == 0) {
+            checkLeafList(tree, expected);
+        }
+    }
+    checkLeafList(tree, expected);
+    
+    std::cout << "✓ wide root test passed!" << std::endl;
+}
+
+void testSplitsAndMerges() {
+    std::cout << "Testing leaf links across splits, merges and deletePrefix..." << std::endl;
+    
+    std::mt19937 rng(22);
+    Tree<std::string, int> tree;
+    std::map<std::string, int> expected;
+    for (int i = 0; i < 20000; i++) {
+        std::string key;
+        int len = rng() % 10;
+        for (int j = 0; j < len; j++) {
+            key.push_back("ab"[rng() % 2]);
+        }
+        int op = rng() % 20;
+        if (op < 12) {
+            tree.insert(key, i);
+            expected[key] = i;
+        } else if (op < 19) {
+            tree.del(key);
+            expected.erase(key);
+        } else {
+            std::string prefix = key.substr(0, 3);
+            tree.deletePrefix(prefix);
+            for (auto it = expected.begin(); it != expected.end();) {
+                it = it->first.compare(0, prefix.size(), prefix) == 0 ? expected.erase(it) : std::next(it);
+            }
+        }
+        if (i % 500 == 0) {
+            checkLeafList(tree, expected);
+        }
+    }
+    checkLeafList(tree, expected);
+    
+    std::cout << "✓ splits and merges test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "Running leaf link tests..." << std::endl;
+    
+    testHighFanout();
+    testSplitsAndMerges();
+    
+    std::cout << "\nAll leaf link tests passed!" << std::endl;
+    return 0;
+}
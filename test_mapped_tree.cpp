@@ -0,0 +1,149 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <cassert>
+#include <cstdio>
+#include "radix/mapped_tree.hpp"
+#include "test_keys.hpp"
+
+// A MappedTree reads the image write() produced straight from the mapping.
+// These tests compare every read operation with the Tree it was written
+// from.
+
+template<typename T>
+void checkAgainstTree(const Tree<std::string, T>& tree, const MappedTree<std::string, T>& mapped,
+                      const std::vector<std::string>& probes) {
+    assert(mapped.len() == tree.len());
+
+    // Ordered iteration and GetAtIndex
+    auto it = tree.iterator();
+    auto mit = mapped.iterator();
+    int index = 0;
+    for (auto res = it.next(); res.found; res = it.next(), index++) {
+        auto mres = mit.next();
+        assert(mres.found && res.key == std::string(mres.key.begin(), mres.key.end()) && res.val == mres.val);
+        auto [k, v, found] = mapped.GetAtIndex(index);
+        assert(found && k == res.key && v == res.val);
+        assert(mapped.Get(res.key) == res.val);
+    }
+    assert(!mit.next().found);
+    assert(!std::get<2>(mapped.GetAtIndex(index)));
+    assert(!std::get<2>(mapped.GetAtIndex(-1)));
+
+    for (const auto& probe : probes) {
+        assert(mapped.Get(probe) == tree.Get(probe));
+
+        auto expected = tree.LongestPrefix(probe);
+        auto actual = mapped.LongestPrefix(probe);
+        assert(actual.found == expected.found);
+        assert(!actual.found || (actual.key == expected.key && actual.val == expected.val));
+
+        assert(mapped.findMatchingPrefixes(probe) == tree.findMatchingPrefixes(probe));
+
+        // Prefix iteration from every prefix length of the probe
+        for (size_t n = 0; n <= probe.size(); n += 3) {
+            std::string prefix = probe.substr(0, n);
+            auto pit = tree.iterator();
+            pit.seekPrefix(prefix);
+            auto mpit = mapped.iterator();
+            mpit.seekPrefix(prefix);
+            for (auto res = pit.next(); res.found; res = pit.next()) {
+                auto mres = mpit.next();
+                assert(mres.found && res.key == std::string(mres.key.begin(), mres.key.end()));
+            }
+            assert(!mpit.next().found);
+        }
+    }
+}
+
+// Spilled prefixes and the odd byte outside the alphabet, so the image
+// holds every kind of prefix
+std::string randomKey(std::mt19937& rng) {
+    auto key = KeyGen{"ab/c", 0, 12, true}(rng);
+    if (rng() % 16 == 0) {
+        key.push_back(static_cast<char>(rng() % 256));
+    }
+    return key;
+}
+
+void testStringValues() {
+    std::cout << "Testing a mapped tree of strings..." << std::endl;
+
+    std::mt19937 rng(17);
+    Tree<std::string, std::string> tree;
+    for (int i = 0; i < 20000; i++) {
+        auto key = randomKey(rng);
+        tree.insert(key, "value-" + std::to_string(i) + std::string(rng() % 20, 'x'));
+    }
+    std::vector<std::string> probes;
+    for (int i = 0; i < 2000; i++) {
+        probes.push_back(randomKey(rng));
+    }
+
+    const std::string path = "test_mapped_tree.img";
+    bool written = MappedTree<std::string, std::string>::write(tree, path);
+    assert(written);
+    auto mapped = MappedTree<std::string, std::string>::open(path);
+    assert(mapped);
+    checkAgainstTree(tree, *mapped, probes);
+
+    // The image does not change when the tree does
+    auto copy = tree;
+    tree.insert("ab/new-key", "new");
+    assert(!mapped->Get(std::string("ab/new-key")));
+    checkAgainstTree(copy, *mapped, probes);
+    std::remove(path.c_str());
+
+    std::cout << "✓ string values test passed!" << std::endl;
+}
+
+void testIntValuesInMemory() {
+    std::cout << "Testing an in-memory image of ints..." << std::endl;
+
+    Tree<std::string, int> tree;
+    std::vector<std::string> keys = {"", "a", "ab", "abc", "abd", "b", "ba", "zzzzzzzzzzzzzzzzzzzz"};
+    for (size_t i = 0; i < keys.size(); i++) {
+        tree.insert(keys[i], static_cast<int>(i) * 10);
+    }
+    auto image = MappedTree<std::string, int>::image(tree);
+    auto mapped = MappedTree<std::string, int>::view(image.data(), image.size());
+    assert(mapped);
+    checkAgainstTree(tree, *mapped, {"", "a", "abcd", "abe", "bb", "zzzz", "zzzzzzzzzzzzzzzzzzzzz", "q"});
+
+    Tree<std::string, int> empty;
+    auto emptyImage = MappedTree<std::string, int>::image(empty);
+    auto emptyMapped = MappedTree<std::string, int>::view(emptyImage.data(), emptyImage.size());
+    assert(emptyMapped && emptyMapped->len() == 0 && !emptyMapped->Get(std::string("")));
+    assert(!emptyMapped->iterator().next().found);
+
+    std::cout << "✓ in-memory image test passed!" << std::endl;
+}
+
+void testRejectsBadImages() {
+    std::cout << "Testing rejected images..." << std::endl;
+
+    assert(!(MappedTree<std::string, int>::open("no-such-file.img")));
+
+    Tree<std::string, int> tree;
+    tree.insert("key", 1);
+    auto image = MappedTree<std::string, int>::image(tree);
+    assert(!(MappedTree<std::string, int>::view(image.data(), image.size() - 8)));
+    auto corrupt = image;
+    corrupt[0] = 'X';
+    assert(!(MappedTree<std::string, int>::view(corrupt.data(), corrupt.size())));
+
+    std::cout << "✓ rejected images test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "Running mapped tree tests..." << std::endl;
+
+    testStringValues();
+    testIntValuesInMemory();
+    testRejectsBadImages();
+
+    std::cout << "\nAll mapped tree tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <random>
+#include <cassert>
+#include "radix/tree.hpp"
+
+// multiGet interleaves lookups, so these tests mix hits, misses and keys
+// that end inside a prefix or at a node without a leaf in one batch, and
+// check every result against Get.
+
+void testMatchesGet() {
+    std::cout << "Testing multiGet against Get..." << std::endl;
+
+    std::mt19937 rng(11);
+    Tree<std::string, int> tree;
+    std::vector<std::string> keys;
+    for (int i = 0; i < 5000; i++) {
+        std::string key;
+        int len = rng() % 10;
+        for (int j = 0; j < len; j++) {
+            key.push_back("abcd"[rng() % 4]);
+        }
+        if (i % 2) {
+            tree.insert(key, i);
+        }
+        keys.push_back(key);
+    }
+
+    // Batches smaller than, equal to and larger than the window
+    for (size_t batch : {size_t(0), size_t(1), size_t(7), size_t(16), size_t(64), keys.size()}) {
+        for (size_t from = 0; from + batch <= keys.size(); from += std::max<size_t>(batch, 1) * 13) {
+            std::vector<std::optional<int>> out(batch, -1);
+            tree.multiGet(keys.data() + from, batch, out.data());
+            for (size_t i = 0; i < batch; i++) {
+                assert(out[i] == tree.Get(keys[from + i]));
+            }
+        }
+    }
+
+    auto all = tree.multiGet(keys);
+    assert(all.size() == keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        assert(all[i] == tree.Get(keys[i]));
+    }
+
+    std::cout << "✓ multiGet test passed!" << std::endl;
+}
+
+void testViewKeys() {
+    std::cout << "Testing multiGet with views into one buffer..." << std::endl;
+
+    Tree<std::string, int> tree;
+    tree.insert("GET /a", 1);
+    tree.insert("GET /ab", 2);
+    tree.insert("", 0);
+
+    std::string packet = "GET /abGET /aGET /";
+    std::string_view views[] = {
+        std::string_view(packet).substr(0, 7),
+        std::string_view(packet).substr(7, 6),
+        std::string_view(packet).substr(13, 5),
+        std::string_view(packet).substr(0, 0),
+    };
+    std::optional<int> out[4];
+    tree.multiGet(views, 4, out);
+    assert(out[0] == 2 && out[1] == 1 && !out[2] && out[3] == 0);
+
+    std::cout << "✓ view keys test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "Running multiGet tests..." << std::endl;
+
+    testMatchesGet();
+    testViewKeys();
+
+    std::cout << "\nAll multiGet tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,223 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <thread>
+#include <cassert>
+#include "radix/olc_tree.hpp"
+
+// Checks an OlcTree against expected through lookups, a view and toTree()
+void checkTree(OlcTree<std::string, int>& tree, const std::map<std::string, int>& expected) {
+    assert(tree.len() == static_cast<int>(expected.size()));
+    auto reader = tree.reader();
+    for (const auto& [key, val] : expected) {
+        assert(reader.Get(key) == val);
+    }
+
+    {
+        auto view = reader.view();
+        auto it = view.iterator();
+        auto exp = expected.begin();
+        for (auto res = it.next(); res.found; res = it.next(), ++exp) {
+            assert(exp != expected.end());
+            assert(res.key == exp->first && res.val == exp->second);
+        }
+        assert(exp == expected.end());
+
+        for (std::string prefix : {"", "a", "ab", "abc", "ca", "cab-a-rather"}) {
+            auto pit = view.iterator();
+            pit.seekPrefix(prefix);
+            auto pexp = expected.lower_bound(prefix);
+            for (auto res = pit.next(); res.found; res = pit.next(), ++pexp) {
+                assert(pexp != expected.end() && pexp->first.compare(0, prefix.size(), prefix) == 0);
+                assert(res.key == pexp->first && res.val == pexp->second);
+            }
+            assert(pexp == expected.end() || pexp->first.compare(0, prefix.size(), prefix) != 0);
+        }
+    }
+
+    auto copy = tree.toTree();
+    assert(copy.len() == static_cast<int>(expected.size()));
+    auto it = copy.iterator();
+    auto exp = expected.begin();
+    for (auto res = it.next(); res.found; res = it.next(), ++exp) {
+        assert(exp != expected.end());
+        assert(res.key == exp->first && res.val == exp->second);
+    }
+    assert(exp == expected.end());
+}
+
+void testSingleWriter() {
+    std::cout << "Testing splits and merges against std::map..." << std::endl;
+
+    std::mt19937 rng(13);
+    OlcTree<std::string, int> tree;
+    std::map<std::string, int> expected;
+    auto writer = tree.writer();
+    for (int i = 0; i < 50000; i++) {
+        // Short keys over a small alphabet split and merge nodes constantly;
+        // some long ones spill their prefixes
+        std::string key;
+        int len = rng() % 7;
+        for (int j = 0; j < len; j++) {
+            key.push_back("abc"[rng() % 3]);
+        }
+        if (rng() % 10 == 0) {
+            key += "-a-rather-long-suffix";
+        }
+        if (rng() % 3) {
+            auto old = writer.insert(key, i);
+            assert(old == (expected.count(key) ? std::optional<int>(expected[key]) : std::nullopt));
+            expected[key] = i;
+        } else {
+            auto old = writer.del(key);
+            assert(old == (expected.count(key) ? std::optional<int>(expected[key]) : std::nullopt));
+            expected.erase(key);
+        }
+        if (i % 5000 == 0) {
+            checkTree(tree, expected);
+        }
+    }
+    checkTree(tree, expected);
+
+    auto longest = writer.LongestPrefix(std::string("abcabcabc"));
+    auto [k, v, found] = longest;
+    for (size_t n = 9;; n--) {
+        auto it = expected.find(std::string("abcabcabc").substr(0, n));
+        if (it != expected.end()) {
+            assert(found && k == it->first && v == it->second);
+            break;
+        }
+        if (n == 0) {
+            assert(!found);
+            break;
+        }
+    }
+
+    std::cout << "✓ single writer test passed!" << std::endl;
+}
+
+void testConcurrentWriters() {
+    std::cout << "Testing concurrent writers and readers..." << std::endl;
+
+    const int kThreads = 4;
+    const int kKeys = 20000;
+    OlcTree<std::string, int> tree;
+
+    // Each writer owns every kThreads-th key: it inserts them all, deletes
+    // the odd ones and updates the rest, so the final contents are known
+    // whatever the interleaving. Keys share long prefixes to force the
+    // writers onto the same nodes.
+    auto keyOf = [](int i) { return "session/" + std::to_string(i % 97) + "/" + std::to_string(i); };
+    std::atomic<bool> done{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([&, t]() {
+            auto writer = tree.writer();
+            for (int i = t; i < kKeys; i += kThreads) {
+                auto old = writer.insert(keyOf(i), i);
+                assert(!old);
+            }
+            for (int i = t; i < kKeys; i += kThreads) {
+                auto old = i % 2 ? writer.del(keyOf(i)) : writer.insert(keyOf(i), -i);
+                assert(old == i);
+                assert(writer.Get(keyOf(i)) == (i % 2 ? std::nullopt : std::optional<int>(-i)));
+            }
+        });
+    }
+    std::thread reader([&]() {
+        auto r = tree.reader();
+        std::mt19937 rng(7);
+        while (!done.load()) {
+            int i = rng() % kKeys;
+            auto val = r.Get(keyOf(i));
+            assert(!val || *val == i || *val == -i);
+        }
+    });
+    for (auto& t : threads) {
+        t.join();
+    }
+    done = true;
+    reader.join();
+
+    std::map<std::string, int> expected;
+    for (int i = 0; i < kKeys; i += 2) {
+        expected[keyOf(i)] = -i;
+    }
+    checkTree(tree, expected);
+
+    std::cout << "✓ concurrent writers test passed!" << std::endl;
+}
+
+void testScanDuringWrites() {
+    std::cout << "Testing ordered scans alongside writers..." << std::endl;
+
+    const int kStable = 2000;
+    OlcTree<std::string, int> tree;
+    auto stableKey = [](int i) { return "user/" + std::to_string(i % 13) + "/" + std::to_string(i); };
+    {
+        auto writer = tree.writer();
+        for (int i = 0; i < kStable; i++) {
+            writer.insert(stableKey(i), i);
+        }
+    }
+
+    // Writers churn keys interleaved with the stable ones, splitting and
+    // merging the nodes a scan is passing through
+    std::atomic<bool> done{false};
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 2; t++) {
+        writers.emplace_back([&, t]() {
+            auto writer = tree.writer();
+            std::mt19937 rng(t);
+            while (!done.load()) {
+                int i = rng() % kStable;
+                auto key = stableKey(i) + "/" + std::to_string(t);
+                writer.insert(key, -1);
+                writer.del(key);
+            }
+        });
+    }
+
+    auto reader = tree.reader();
+    for (int round = 0; round < 20; round++) {
+        auto view = reader.view();
+        auto it = view.iterator();
+        if (round % 2) {
+            it.seekPrefix(std::string("user/7/"));
+        }
+        std::string last;
+        int stable = 0;
+        for (auto res = it.next(); res.found; res = it.next()) {
+            assert(last.empty() || last < res.key);
+            last = res.key;
+            if (res.val >= 0) {
+                assert(res.key == stableKey(res.val));
+                stable++;
+            }
+        }
+        int expected = 0;
+        for (int i = 0; i < kStable; i++) {
+            expected += round % 2 == 0 || i % 13 == 7;
+        }
+        assert(stable == expected);
+    }
+    done = true;
+    for (auto& t : writers) {
+        t.join();
+    }
+
+    std::cout << "✓ scan during writes test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "Running OLC tree tests..." << std::endl;
+
+    testSingleWriter();
+    testConcurrentWriters();
+    testScanDuringWrites();
+
+    std::cout << "\nAll OLC tree tests passed!" << std::endl;
+    return 0;
+}
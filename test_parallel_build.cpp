@@ -0,0 +1,124 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <cassert>
+#include "radix/tree.hpp"
+#include "test_keys.hpp"
+
+std::vector<std::pair<std::string, int>> randomEntries(std::mt19937& rng, int count, const std::string& stem) {
+    std::vector<std::pair<std::string, int>> entries;
+    for (int i = 0; i < count; i++) {
+        std::string key = stem.substr(0, rng() % (stem.size() + 1));
+        int len = rng() % 12;
+        for (int j = 0; j < len; j++) {
+            key.push_back(static_cast<char>("abcxyz/\x80\xff"[rng() % 9]));
+        }
+        entries.push_back({key, i});
+    }
+    return entries;
+}
+
+void testMatchesInsert() {
+    std::cout << "Testing fromUnsorted against insert..." << std::endl;
+    
+    std::mt19937 rng(11);
+    auto entries = randomEntries(rng, 50000, "");
+    std::map<std::string, int> expected;
+    for (const auto& [key, val] : entries) {
+        expected[key] = val;  // later duplicates win
+    }
+    
+    for (unsigned threads : {1u, 4u}) {
+        auto tree = Tree<std::string, int>::fromUnsorted(entries, threads);
+        checkTree(tree, expected);
+    }
+    
+    std::cout << "✓ fromUnsorted matches insert test passed!" << std::endl;
+}
+
+void testDeeperPartitions() {
+    std::cout << "Testing fromUnsorted with multi-byte partitions..." << std::endl;
+    
+    // Most keys share a stem, so partitioning on one byte would leave a
+    // single partition; keys shorter than the partition width go in the top
+    std::mt19937 rng(12);
+    auto entries = randomEntries(rng, 30000, "/api/v1/");
+    entries.push_back({"", -1});
+    std::map<std::string, int> expected;
+    for (const auto& [key, val] : entries) {
+        expected[key] = val;
+    }
+    
+    for (size_t partitionBytes : {2u, 5u, 9u}) {
+        auto tree = Tree<std::string, int>::fromUnsorted(entries, 4, partitionBytes);
+        checkTree(tree, expected);
+    }
+    
+    std::cout << "✓ multi-byte partitions test passed!" << std::endl;
+}
+
+void testMutateAfterBuild() {
+    std::cout << "Testing updates on a parallel-built tree..." << std::endl;
+    
+    std::mt19937 rng(13);
+    auto entries = randomEntries(rng, 20000, "ab");
+    std::map<std::string, int> expected;
+    for (const auto& [key, val] : entries) {
+        expected[key] = val;
+    }
+    auto tree = Tree<std::string, int>::fromUnsorted(entries, 3, 2);
+    
+    auto more = randomEntries(rng, 10000, "ab");
+    for (size_t i = 0; i < more.size(); i++) {
+        if (i % 2) {
+            tree.insert(more[i].first, more[i].second);
+            expected[more[i].first] = more[i].second;
+        } else {
+            tree.del(more[i].first);
+            expected.erase(more[i].first);
+        }
+    }
+    tree.deletePrefix("abx");
+    for (auto it = expected.begin(); it != expected.end();) {
+        it = it->first.compare(0, 3, "abx") == 0 ? expected.erase(it) : std::next(it);
+    }
+    checkTree(tree, expected);
+    
+    std::cout << "✓ updates after build test passed!" << std::endl;
+}
+
+void testEdgeCases() {
+    std::cout << "Testing fromUnsorted edge cases..." << std::endl;
+    
+    std::vector<std::pair<std::string, int>> empty;
+    auto emptyTree = Tree<std::string, int>::fromUnsorted(empty, 4);
+    assert(emptyTree.len() == 0);
+    assert(!emptyTree.iterator().next().found);
+    
+    std::vector<std::pair<std::string, int>> single = {{"only", 1}};
+    auto singleTree = Tree<std::string, int>::fromUnsorted(single, 4, 3);
+    checkTree(singleTree, std::map<std::string, int>{{"only", 1}});
+    
+    std::vector<std::pair<std::vector<uint8_t>, std::string>> bytes = {
+        {{0xff, 0x01}, "a"}, {{0x00}, "b"}, {{0x00, 0x01}, "c"}, {{0x80}, "d"}, {{0x00}, "e"}
+    };
+    auto byteTree = Tree<std::vector<uint8_t>, std::string>::fromUnsorted(bytes, 2);
+    checkTree(byteTree, std::map<std::vector<uint8_t>, std::string>{
+        {{0x00}, "e"}, {{0x00, 0x01}, "c"}, {{0x80}, "d"}, {{0xff, 0x01}, "a"}});
+    
+    std::cout << "✓ edge cases test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "Running parallel build tests..." << std::endl;
+    
+    testMatchesInsert();
+    testDeeperPartitions();
+    testMutateAfterBuild();
+    testEdgeCases();
+    
+    std::cout << "\nAll parallel build tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,157 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+#include <cassert>
+#include "radix/tree.hpp"
+#include "test_keys.hpp"
+
+// parallelForEach and parallelReduce split the keys into chunks by index
+// and walk each on its own thread. These tests check that every key is
+// visited once, that reductions come out in key order and that prefix
+// scans cover exactly the prefix's keys.
+
+Tree<std::string, int> randomTree(Map& expected, int count) {
+    std::mt19937 rng(25);
+    Tree<std::string, int> tree;
+    fillRandom(tree, expected, rng, KeyGen{"ab/\xff", 1, 13}, count);
+    return tree;
+}
+
+void testForEach() {
+    std::cout << "Testing parallelForEach..." << std::endl;
+
+    Map expected;
+    auto tree = randomTree(expected, 60000);
+
+    for (unsigned threads : {0u, 1u, 3u, 8u}) {
+        std::mutex mu;
+        Visited seen;
+        tree.parallelForEach([&](KeyView<char> key, const int& val) {
+            std::lock_guard<std::mutex> lock(mu);
+            seen.push_back({std::string(key.begin(), key.end()), val});
+        }, threads);
+        std::sort(seen.begin(), seen.end());
+        assert(seen == Visited(expected.begin(), expected.end()));
+    }
+
+    // Under a prefix, and under one that matches nothing
+    for (std::string prefix : {"", "a", "ab/", "\xff\xff", "ab/ab/ab/ab/ab", "c"}) {
+        std::atomic<int> count{0};
+        std::atomic<long> sum{0};
+        tree.parallelForEachPrefix(prefix, [&](KeyView<char>, const int& val) {
+            count++;
+            sum += val;
+        }, 4);
+        auto under = entriesUnder(expected, prefix);
+        int expectedCount = static_cast<int>(under.size());
+        long expectedSum = 0;
+        for (const auto& entry : under) {
+            expectedSum += entry.second;
+        }
+        assert(count == expectedCount && sum == expectedSum);
+        assert(count == tree.countPrefix(prefix));
+    }
+
+    // Returning false stops the scan
+    std::atomic<int> visited{0};
+    tree.parallelForEach([&](KeyView<char>, const int&) { return ++visited < 10; }, 4);
+    assert(visited >= 10 && visited < static_cast<int>(expected.size()));
+
+    std::cout << "✓ parallelForEach test passed!" << std::endl;
+}
+
+void testReduce() {
+    std::cout << "Testing parallelReduce..." << std::endl;
+
+    Map expected;
+    auto tree = randomTree(expected, 60000);
+
+    long sum = 0;
+    for (const auto& [key, val] : expected) {
+        sum += val;
+    }
+    auto add = [](long acc, KeyView<char>, const int& val) { return acc + val; };
+    auto plus = [](long a, long b) { return a + b; };
+    for (unsigned threads : {0u, 1u, 2u, 7u}) {
+        assert(tree.parallelReduce(0L, add, plus, threads) == sum);
+    }
+
+    // Chunk results are combined in key order, so gathering the keys gives
+    // them sorted
+    auto gather = [](std::vector<std::string> acc, KeyView<char> key, const int&) {
+        acc.emplace_back(key.begin(), key.end());
+        return acc;
+    };
+    auto join = [](std::vector<std::string> a, std::vector<std::string> b) {
+        a.insert(a.end(), b.begin(), b.end());
+        return a;
+    };
+    auto keys = tree.parallelReduce(std::vector<std::string>{}, gather, join, 5);
+    std::vector<std::string> expectedKeys;
+    for (const auto& entry : expected) {
+        expectedKeys.push_back(entry.first);
+    }
+    assert(keys == expectedKeys);
+
+    auto under = tree.parallelReducePrefix(std::string("b"), std::vector<std::string>{}, gather, join, 3);
+    assert(under == std::vector<std::string>(std::lower_bound(expectedKeys.begin(), expectedKeys.end(), "b"),
+                                             std::lower_bound(expectedKeys.begin(), expectedKeys.end(), "c")));
+    assert(tree.parallelReducePrefix(std::string("c"), -1L, add, plus) == -1);
+
+    Tree<std::string, int> empty;
+    assert(empty.parallelReduce(0L, add, plus, 4) == 0);
+
+    std::cout << "✓ parallelReduce test passed!" << std::endl;
+}
+
+void testSnapshots() {
+    std::cout << "Testing parallel scans of older snapshots..." << std::endl;
+
+    Map expected;
+    auto tree = randomTree(expected, 20000);
+    auto snapshot = tree;
+    for (const auto& entry : expected) {
+        if (entry.second % 2) {
+            tree.del(entry.first);
+        }
+    }
+    tree.insert("new", 1);
+
+    auto count = [](long acc, KeyView<char>, const int&) { return acc + 1; };
+    auto plus = [](long a, long b) { return a + b; };
+    assert(snapshot.parallelReduce(0L, count, plus, 4) == static_cast<long>(expected.size()));
+    assert(tree.parallelReduce(0L, count, plus, 4) == static_cast<long>(tree.len()));
+
+    // A snapshot is scanned on workers while another thread writes the
+    // tree it was taken from
+    auto latest = tree;
+    long latestCount = tree.len();
+    std::thread writer([&]() {
+        for (int i = 0; i < 2000; i++) {
+            tree.insert("w" + std::to_string(i), i);
+            tree.del("w" + std::to_string(i / 2));
+        }
+    });
+    for (int i = 0; i < 20; i++) {
+        assert(latest.parallelReduce(0L, count, plus, 4) == latestCount);
+    }
+    writer.join();
+
+    std::cout << "✓ snapshot test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "Running parallel scan tests..." << std::endl;
+
+    testForEach();
+    testReduce();
+    testSnapshots();
+
+    std::cout << "\nAll parallel scan tests passed!" << std::endl;
+    return 0;
+}
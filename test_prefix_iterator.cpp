@@ -0,0 +1,92 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <cassert>
+#include "radix/tree.hpp"
+#include "test_keys.hpp"
+
+// PrefixIterator returns the keys that are prefixes of a path, one node
+// per step and without allocating. These tests compare it with a std::map
+// and check its steps.
+
+// Paths of short segments; some keys spill their prefixes
+const KeyGen kKeys{"ab/", 0, 10, true};
+
+void testAgainstMap() {
+    std::cout << "Testing prefix iteration against std::map..." << std::endl;
+
+    std::mt19937 rng(24);
+    Tree<std::string, int> tree;
+    Map expected;
+    fillRandom(tree, expected, rng, kKeys, 5000);
+
+    for (int i = 0; i < 2000; i++) {
+        auto path = kKeys(rng) + kKeys(rng);
+        auto prefixes = entriesAlong(expected, path);
+
+        auto pit = tree.prefixIterator(path);
+        for (const auto& [key, val] : prefixes) {
+            auto res = pit.next();
+            assert(res.found && res.key == key && res.val == val);
+        }
+        assert(!pit.next().found && !pit.nextLeaf());
+        assert(tree.findMatchingPrefixes(path).size() == (path.empty() ? 0 : prefixes.size()));
+    }
+
+    std::cout << "✓ std::map comparison test passed!" << std::endl;
+}
+
+void testSteps() {
+    std::cout << "Testing prefix iteration step by step..." << std::endl;
+
+    Tree<std::string, int> tree;
+    tree.insert("", 0);
+    tree.insert("a", 1);
+    tree.insert("a/b", 2);
+    std::string path = "a/b/c";
+
+    // The iterator is the node, the path view, an offset and the handle of
+    // a path it was handed
+    static_assert(sizeof(PrefixIterator<std::string, int>) <= 6 * sizeof(void*), "no stack held");
+
+    auto pit = tree.prefixIterator(path);
+    auto first = pit.nextLeaf();
+    assert(first && first->key == std::string(""));
+
+    // Copies resume from the same step
+    auto rest = pit;
+    assert(rest.nextLeaf()->val == 1);
+    assert(rest.nextLeaf()->val == 2);
+    assert(!rest.nextLeaf());
+    assert(pit.nextLeaf()->val == 1);
+
+    Tree<std::string, int> empty;
+    assert(!empty.prefixIterator(path).next().found);
+
+    // A temporary or literal path is kept by the iterator and its copies,
+    // however long they outlive the call
+    auto owning = tree.prefixIterator(path + "/d");
+    auto literal = tree.prefixIterator("a/");
+    path.assign("zzzzzzzzzzzzzzzzzzzzzzzzzzzzzzzz");
+    assert(owning.nextLeaf()->val == 0);
+    auto moved = std::move(owning);
+    assert(moved.nextLeaf()->val == 1);
+    assert(moved.nextLeaf()->val == 2);
+    assert(!moved.nextLeaf());
+    assert(literal.nextLeaf()->val == 0);
+    assert(literal.nextLeaf()->val == 1);
+    assert(!literal.nextLeaf());
+
+    std::cout << "✓ step test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "Running prefix iterator tests..." << std::endl;
+
+    testAgainstMap();
+    testSteps();
+
+    std::cout << "\nAll prefix iterator tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <set>
+#include <random>
+#include <iterator>
+#include <cassert>
+#include "radix/tree.hpp"
+#include "test_keys.hpp"
+
+// rank, countRange and countPrefix are computed from the per-node key
+// counts instead of by iterating. These tests compare them with a std::set
+// holding the same keys, for probes inside and outside the tree.
+
+// Bytes above 0x7f check that keys are ordered as unsigned bytes
+const KeyGen kKeys{"ab/\xff\x80", 0, 8, true};
+
+int expectedRank(const std::set<std::string>& keys, const std::string& key) {
+    return static_cast<int>(std::distance(keys.begin(), keys.lower_bound(key)));
+}
+
+int expectedPrefixCount(const std::set<std::string>& keys, const std::string& prefix) {
+    int count = 0;
+    for (auto it = keys.lower_bound(prefix); it != keys.end() && it->compare(0, prefix.size(), prefix) == 0; ++it) {
+        count++;
+    }
+    return count;
+}
+
+void checkCounts(const Tree<std::string, int>& tree, const std::set<std::string>& keys,
+                 const std::vector<std::string>& probes) {
+    int index = 0;
+    for (const auto& key : keys) {
+        assert(tree.rank(key) == index);
+        assert(std::get<0>(tree.GetAtIndex(tree.rank(key))) == key);
+        index++;
+    }
+    for (size_t i = 0; i < probes.size(); i++) {
+        const auto& probe = probes[i];
+        assert(tree.rank(probe) == expectedRank(keys, probe));
+        assert(tree.countPrefix(probe) == expectedPrefixCount(keys, probe));
+
+        const auto& other = probes[(i * 7 + 3) % probes.size()];
+        int expected = probe < other ? expectedRank(keys, other) - expectedRank(keys, probe) : 0;
+        assert(tree.countRange(probe, other) == expected);
+    }
+    assert(tree.countPrefix(std::string("")) == static_cast<int>(keys.size()));
+}
+
+void testAgainstSet() {
+    std::cout << "Testing rank and counts against std::set..." << std::endl;
+
+    std::mt19937 rng(20);
+    Tree<std::string, int> tree;
+    std::set<std::string> keys;
+    fillRandom(tree, keys, rng, kKeys, 5000);
+    std::vector<std::string> probes;
+    for (int i = 0; i < 2000; i++) {
+        probes.push_back(kKeys(rng));
+    }
+    checkCounts(tree, keys, probes);
+
+    // Counts stay right as keys and whole prefixes are deleted
+    for (int i = 0; i < 1000; i++) {
+        auto key = kKeys(rng);
+        tree.del(key);
+        keys.erase(key);
+    }
+    tree.deletePrefix(std::string("ab"));
+    keys.erase(keys.lower_bound("ab"), keys.lower_bound("ac"));
+    checkCounts(tree, keys, probes);
+
+    std::cout << "✓ std::set comparison test passed!" << std::endl;
+}
+
+void testSmallTrees() {
+    std::cout << "Testing rank on small trees..." << std::endl;
+
+    Tree<std::string, int> empty;
+    assert(empty.rank(std::string("a")) == 0 && empty.countPrefix(std::string("")) == 0);
+    assert(empty.countRange(std::string(""), std::string("z")) == 0);
+
+    Tree<std::string, int> tree;
+    for (const char* key : {"", "apple", "application", "apply", "banana"}) {
+        tree.insert(key, 0);
+    }
+    assert(tree.rank(std::string("")) == 0);
+    assert(tree.rank(std::string("a")) == 1);
+    assert(tree.rank(std::string("appl")) == 1);
+    assert(tree.rank(std::string("apple")) == 1);
+    assert(tree.rank(std::string("applf")) == 2);
+    assert(tree.rank(std::string("apply")) == 3);
+    assert(tree.rank(std::string("b")) == 4);
+    assert(tree.rank(std::string("z")) == 5);
+    assert(tree.countPrefix(std::string("app")) == 3);
+    assert(tree.countPrefix(std::string("appli")) == 1);
+    assert(tree.countPrefix(std::string("apples")) == 0);
+    assert(tree.countPrefix(std::string("c")) == 0);
+    assert(tree.countRange(std::string("apple"), std::string("apply")) == 2);
+    assert(tree.countRange(std::string("z"), std::string("a")) == 0);
+
+    std::cout << "✓ small tree test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "Running rank tests..." << std::endl;
+
+    testAgainstSet();
+    testSmallTrees();
+
+    std::cout << "\nAll rank tests passed!" << std::endl;
+    return 0;
+}
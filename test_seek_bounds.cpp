@@ -0,0 +1,135 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <set>
+#include <random>
+#include <cassert>
+#include "radix/tree.hpp"
+#include "test_keys.hpp"
+
+// seekLowerBound, seekUpperBound and seekReverseLowerBound position an
+// iterator on a key that need not be in the tree. These tests compare what
+// the iterators return from there with std::set bounds on the same keys.
+
+// Bytes above 0x7f check that bounds order keys as unsigned bytes
+const KeyGen kKeys{"ab/\xff\x80", 0, 8, true};
+
+void checkForward(Iterator<std::string, int> it, std::set<std::string>::const_iterator from,
+                  std::set<std::string>::const_iterator last) {
+    for (auto res = it.next(); res.found; res = it.next(), ++from) {
+        assert(from != last && res.key == *from);
+    }
+    assert(from == last);
+}
+
+// Iterates backward from it and checks it returns the keys before last,
+// down to first
+void checkBackward(ReverseIterator<std::string, int> it, std::set<std::string>::const_iterator first,
+                   std::set<std::string>::const_iterator last) {
+    for (auto res = it.previous(); res.found; res = it.previous()) {
+        assert(last != first);
+        --last;
+        assert(res.key == *last);
+    }
+    assert(last == first);
+}
+
+void testAgainstSet() {
+    std::cout << "Testing bounds against std::set..." << std::endl;
+
+    std::mt19937 rng(21);
+    Tree<std::string, int> tree;
+    std::set<std::string> keys;
+    fillRandom(tree, keys, rng, kKeys, 3000);
+    for (int i = 0; i < 500; i++) {
+        auto key = kKeys(rng);
+        tree.del(key);
+        keys.erase(key);
+    }
+
+    std::vector<std::string> probes(keys.begin(), keys.end());
+    for (int i = 0; i < 1000; i++) {
+        probes.push_back(kKeys(rng));
+    }
+    for (const auto& probe : probes) {
+        auto lower = tree.iterator();
+        lower.seekLowerBound(probe);
+        checkForward(lower, keys.lower_bound(probe), keys.end());
+
+        auto upper = tree.iterator();
+        upper.seekUpperBound(probe);
+        checkForward(upper, keys.upper_bound(probe), keys.end());
+
+        auto reverse = tree.reverseIterator();
+        reverse.seekReverseLowerBound(probe);
+        checkBackward(reverse, keys.begin(), keys.upper_bound(probe));
+    }
+
+    std::cout << "✓ std::set comparison test passed!" << std::endl;
+}
+
+void testWithinPrefix() {
+    std::cout << "Testing bounds after seekPrefix..." << std::endl;
+
+    Tree<std::string, int> tree;
+    std::set<std::string> keys;
+    for (const char* key : {"a", "app", "apple", "apply", "apricot", "b", "banana"}) {
+        tree.insert(key, 0);
+        keys.insert(key);
+    }
+    // The bound stays inside the prefix on both sides, including a prefix
+    // that ends partway through a node's prefix
+    for (std::string prefix : {"ap", "apr", "ban", "a"}) {
+        std::set<std::string> under;
+        for (const auto& key : keys) {
+            if (key.compare(0, prefix.size(), prefix) == 0) {
+                under.insert(key);
+            }
+        }
+        for (std::string probe : {"", "a", "apple", "applf", "apr", "apricots", "az", "ban", "c"}) {
+            auto it = tree.iterator();
+            it.seekPrefix(prefix);
+            it.seekLowerBound(probe);
+            checkForward(it, under.lower_bound(probe), under.end());
+
+            auto uit = tree.iterator();
+            uit.seekPrefix(prefix);
+            uit.seekUpperBound(probe);
+            checkForward(uit, under.upper_bound(probe), under.end());
+
+            auto rit = tree.reverseIterator();
+            rit.seekPrefix(prefix);
+            rit.seekReverseLowerBound(probe);
+            checkBackward(rit, under.begin(), under.upper_bound(probe));
+        }
+    }
+
+    // A range scan of [lo, hi)
+    auto it = tree.iterator();
+    it.seekLowerBound(std::string("apple"));
+    std::vector<std::string> range;
+    for (auto res = it.next(); res.found && res.key < "b"; res = it.next()) {
+        range.push_back(res.key);
+    }
+    assert((range == std::vector<std::string>{"apple", "apply", "apricot"}));
+
+    Tree<std::string, int> empty;
+    auto eit = empty.iterator();
+    eit.seekLowerBound(std::string("a"));
+    assert(!eit.next().found);
+    auto erit = empty.reverseIterator();
+    erit.seekReverseLowerBound(std::string("a"));
+    assert(!erit.previous().found);
+
+    std::cout << "✓ prefix bounds test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "Running seek bound tests..." << std::endl;
+
+    testAgainstSet();
+    testWithinPrefix();
+
+    std::cout << "\nAll seek bound tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,164 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <thread>
+#include <cassert>
+#include "radix/sharded_tree.hpp"
+#include "test_keys.hpp"
+
+// Checks every cross-shard read path of tree against expected
+void checkTree(const ShardedTree<std::string, int>& tree, const Map& expected) {
+    assert(tree.len() == static_cast<int>(expected.size()));
+
+    {
+        auto it = tree.iterator();
+        auto exp = expected.begin();
+        for (auto res = it.next(); res.found; res = it.next(), ++exp) {
+            assert(exp != expected.end());
+            assert(res.key == exp->first && res.val == exp->second);
+        }
+        assert(exp == expected.end());
+    }
+
+    int i = 0;
+    for (const auto& [key, val] : expected) {
+        assert(tree.Get(key) == val);
+        auto [k, v, found] = tree.GetAtIndex(i++);
+        assert(found && k == key && v == val);
+    }
+    assert(!std::get<2>(tree.GetAtIndex(i)));
+}
+
+// Letters on both sides of the split points
+const KeyGen kKeys{"abcmz", 0, 6};
+
+void testAcrossShards() {
+    std::cout << "Testing ordered reads across shards..." << std::endl;
+
+    // Split points inside runs of shared prefixes, so prefixes straddle shards
+    ShardedTree<std::string, int> tree(std::vector<std::string>{"ab", "abm", "b", "m", "mzz"});
+    assert(tree.size() == 6);
+    std::mt19937 rng(5);
+    Map expected;
+    for (int i = 0; i < 20000; i++) {
+        auto key = kKeys(rng);
+        if (rng() % 4) {
+            auto old = tree.insert(key, i);
+            assert(old == (expected.count(key) ? std::optional<int>(expected[key]) : std::nullopt));
+            expected[key] = i;
+        } else {
+            auto old = tree.del(key);
+            assert(old == (expected.count(key) ? std::optional<int>(expected[key]) : std::nullopt));
+            expected.erase(key);
+        }
+    }
+    checkTree(tree, expected);
+
+    for (std::string prefix : {"", "a", "ab", "abm", "abz", "m", "mz", "mzz", "zz"}) {
+        auto it = tree.iterator();
+        it.seekPrefix(prefix);
+        auto exp = expected.lower_bound(prefix);
+        for (auto res = it.next(); res.found; res = it.next(), ++exp) {
+            assert(exp != expected.end() && res.key == exp->first && res.val == exp->second);
+        }
+        assert(exp == expected.end() || exp->first.compare(0, prefix.size(), prefix) != 0);
+    }
+
+    for (int i = 0; i < 1000; i++) {
+        auto search = kKeys(rng) + kKeys(rng);
+        auto [key, val, found] = tree.LongestPrefix(search);
+        auto along = entriesAlong(expected, search);
+        assert(found == !along.empty());
+        assert(!found || (key == along.back().first && val == along.back().second));
+    }
+
+    int deleted = tree.deletePrefix("ab");
+    int erased = 0;
+    for (auto it = expected.lower_bound("ab"); it != expected.end() && it->first.compare(0, 2, "ab") == 0;) {
+        it = expected.erase(it);
+        erased++;
+    }
+    assert(deleted == erased);
+    checkTree(tree, expected);
+
+    std::cout << "✓ cross-shard reads test passed!" << std::endl;
+}
+
+void testParallelWriters() {
+    std::cout << "Testing parallel writers..." << std::endl;
+
+    const int kThreads = 4;
+    const int kKeys = 40000;
+    auto keyOf = [](int i) { return std::to_string(i * 7919 % 100003); };
+    std::vector<std::string> sample;
+    for (int i = 0; i < kKeys; i += 100) {
+        sample.push_back(keyOf(i));
+    }
+    ShardedTree<std::string, int> tree(ShardedTree<std::string, int>::splitsFromSample(sample, 8));
+    assert(tree.size() == 8);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([&, t]() {
+            for (int i = t; i < kKeys; i += kThreads) {
+                tree.insert(keyOf(i), i);
+                assert(tree.Get(keyOf(i)) == i);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    Map expected;
+    for (int i = 0; i < kKeys; i++) {
+        expected[keyOf(i)] = i;
+    }
+    checkTree(tree, expected);
+
+    std::cout << "✓ parallel writers test passed!" << std::endl;
+}
+
+void testLongestPrefixJumps() {
+    std::cout << "Testing LongestPrefix over many narrow shards..." << std::endl;
+
+    // Splits drawn from the keys themselves are often prefixes of a search
+    // or share a long run with it, so a miss has to jump back past them
+    const KeyGen paths{"ab/", 1, 10};
+    std::mt19937 rng(9);
+    std::vector<std::string> sample;
+    for (int i = 0; i < 2000; i++) {
+        sample.push_back(paths(rng));
+    }
+    ShardedTree<std::string, int> tree(ShardedTree<std::string, int>::splitsFromSample(sample, 64));
+    Map expected;
+    fillRandom(tree, expected, rng, paths, 300);
+
+    for (int round = 0; round < 2; round++) {
+        for (int i = 0; i < 3000; i++) {
+            auto search = paths(rng) + paths(rng);
+            auto [key, val, found] = tree.LongestPrefix(search);
+            auto along = entriesAlong(expected, search);
+            assert(found == !along.empty());
+            assert(!found || (key == along.back().first && val == along.back().second));
+        }
+        // The empty key is a prefix of everything and lives in shard 0
+        tree.insert("", -1);
+        expected[""] = -1;
+    }
+
+    std::cout << "✓ LongestPrefix jumps test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "Running sharded tree tests..." << std::endl;
+
+    testAcrossShards();
+    testParallelWriters();
+    testLongestPrefixJumps();
+
+    std::cout << "\nAll sharded tree tests passed!" << std::endl;
+    return 0;
+}
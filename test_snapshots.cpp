@@ -0,0 +1,260 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <thread>
+#include <cassert>
+#include "radix/tree.hpp"
+
+// Writes copy the path they change, so a Tree value taken before a write
+// keeps its contents. These tests hold several snapshots across mixed
+// updates and check each one against the map it was taken from.
+
+// Checks every read path of tree against expected
+template<typename K, typename T>
+void checkTree(const Tree<K, T>& tree, const std::map<K, T>& expected) {
+    assert(tree.len() == static_cast<int>(expected.size()));
+    assert(tree.GetLeavesInSubtree() == static_cast<int>(expected.size()));
+
+    auto it = tree.iterator();
+    auto exp = expected.begin();
+    for (auto res = it.next(); res.found; res = it.next(), ++exp) {
+        assert(exp != expected.end());
+        assert(res.key == exp->first && res.val == exp->second);
+    }
+    assert(exp == expected.end());
+
+    auto rit = tree.reverseIterator();
+    auto rexp = expected.rbegin();
+    for (auto res = rit.previous(); res.found; res = rit.previous(), ++rexp) {
+        assert(rexp != expected.rend());
+        assert(res.key == rexp->first && res.val == rexp->second);
+    }
+    assert(rexp == expected.rend());
+
+    int i = 0;
+    for (const auto& [key, val] : expected) {
+        assert(tree.Get(key) == val);
+        auto [k, v, found] = tree.GetAtIndex(i++);
+        assert(found && k == key && v == val);
+    }
+}
+
+void testSnapshotsSurviveWrites() {
+    std::cout << "Testing snapshots across inserts, updates and deletes..." << std::endl;
+
+    std::mt19937 rng(31);
+    Tree<std::string, int> tree;
+    std::map<std::string, int> expected;
+    std::vector<std::pair<Tree<std::string, int>, std::map<std::string, int>>> snapshots;
+    for (int i = 0; i < 20000; i++) {
+        std::string key;
+        int len = rng() % 8;
+        for (int j = 0; j < len; j++) {
+            key.push_back("abc"[rng() % 3]);
+        }
+        int op = rng() % 20;
+        if (op < 12) {
+            tree.insert(key, i);
+            expected[key] = i;
+        } else if (op < 19) {
+            tree.del(key);
+            expected.erase(key);
+        } else {
+            std::string prefix = key.substr(0, 2);
+            tree.deletePrefix(prefix);
+            for (auto it = expected.begin(); it != expected.end();) {
+                it = it->first.compare(0, prefix.size(), prefix) == 0 ? expected.erase(it) : std::next(it);
+            }
+        }
+        if (i % 1000 == 0) {
+            snapshots.push_back({tree, expected});
+        }
+        // Dropping old snapshots lets the tree write in place again
+        if (snapshots.size() > 8) {
+            snapshots.erase(snapshots.begin());
+        }
+    }
+    checkTree(tree, expected);
+    for (const auto& [snapshot, contents] : snapshots) {
+        checkTree(snapshot, contents);
+    }
+    checkTree(tree, expected);
+
+    std::cout << "✓ snapshots test passed!" << std::endl;
+}
+
+void testPathCopying() {
+    std::cout << "Testing that only unshared nodes are written in place..." << std::endl;
+
+    Tree<std::string, int> tree;
+    tree.insert("alpha", 1);
+    tree.insert("beta", 2);
+
+    // Nothing else holds the tree, so the root is written in place
+    auto root = tree.getRoot();
+    tree.insert("gamma", 3);
+    assert(tree.getRoot() == root);
+
+    // A snapshot makes the next write copy the root, but the copy belongs
+    // to the tree and is not copied again
+    auto snapshot = tree;
+    tree.insert("delta", 4);
+    assert(tree.getRoot() != root && snapshot.getRoot() == root);
+    root = tree.getRoot();
+    tree.insert("epsilon", 5);
+    assert(tree.getRoot() == root);
+    assert(snapshot.len() == 3 && !snapshot.Get("delta") && tree.len() == 5);
+
+    tree.insert("alpha", 10);
+    assert(snapshot.Get("alpha") == 1 && tree.Get("alpha") == 10);
+
+    std::cout << "✓ path copying test passed!" << std::endl;
+}
+
+void testIsolatedTransactions() {
+    std::cout << "Testing isolated transactions..." << std::endl;
+
+    Tree<std::string, int> tree;
+    std::map<std::string, int> expected;
+    for (int i = 0; i < 100; i++) {
+        tree.insert("key" + std::to_string(i), i);
+        expected["key" + std::to_string(i)] = i;
+    }
+
+    // Uncommitted writes are not visible, and are dropped with the transaction
+    {
+        auto txn = tree.txn();
+        txn.insert(std::string("key5x"), -1);
+        txn.del(std::string("key7"));
+        txn.deletePrefix(std::string("key9"));
+        checkTree(tree, expected);
+    }
+    checkTree(tree, expected);
+
+    // Repeated writes in one transaction, then commit
+    auto before = tree;
+    auto txn = tree.txn();
+    for (int i = 0; i < 50; i++) {
+        txn.insert("new" + std::to_string(i), i);
+        expected["new" + std::to_string(i)] = i;
+    }
+    txn.insert(std::string("key3"), 33);
+    expected["key3"] = 33;
+    txn.del(std::string("key4"));
+    expected.erase("key4");
+    auto committed = txn.commit();
+    checkTree(tree, expected);
+    checkTree(committed, expected);
+    assert(before.len() == 100 && before.Get("key3") == 3 && before.Get("key4") == 4);
+
+    std::cout << "✓ isolated transactions test passed!" << std::endl;
+}
+
+// Collects what an iterator returns from where it stands
+std::vector<std::string> rest(Iterator<std::string, int> it) {
+    std::vector<std::string> keys;
+    for (auto res = it.next(); res.found; res = it.next()) {
+        keys.push_back(res.key);
+    }
+    return keys;
+}
+
+void testIteratorsAcrossWrites() {
+    std::cout << "Testing snapshot iterators across writes..." << std::endl;
+
+    using Keys = std::vector<std::string>;
+
+    // A snapshot iterator stays on its own contents while the tree it was
+    // taken from is written
+    Tree<std::string, int> tree;
+    for (const char* key : {"a", "c", "e"}) {
+        tree.insert(key, 0);
+    }
+    auto old = tree;
+    auto it = old.iterator();
+    assert(it.next().key == "a");
+    auto rit = old.reverseIterator();
+    assert(rit.previous().key == "e");
+    tree.insert("d", 0);
+    tree.del("e");
+    tree.insert("b", 0);
+    assert((rest(it) == Keys{"c", "e"}));
+    assert(rit.previous().key == "c" && rit.previous().key == "a" && !rit.previous().found);
+    assert((rest(tree.iterator()) == Keys{"a", "b", "c", "d"}));
+
+    // Iterators of two versions, interleaved
+    auto a = tree.iterator();
+    auto b = old.iterator();
+    Keys fromTree, fromOld;
+    for (int i = 0; i < 4; i++) {
+        auto x = a.next();
+        auto y = b.next();
+        if (x.found) {
+            fromTree.push_back(x.key);
+        }
+        if (y.found) {
+            fromOld.push_back(y.key);
+        }
+    }
+    assert((fromTree == Keys{"a", "b", "c", "d"}));
+    assert((fromOld == Keys{"a", "c", "e"}));
+
+    // Once the snapshot is gone the tree's next write takes the leaf list
+    // back, and iteration stays right through further writes
+    old = Tree<std::string, int>();
+    tree.insert("f", 0);
+    tree.del("a");
+    assert((rest(tree.iterator()) == Keys{"b", "c", "d", "f"}));
+
+    std::cout << "✓ iterators across writes test passed!" << std::endl;
+}
+
+void testConcurrentSnapshotReads() {
+    std::cout << "Testing snapshots iterated on two threads..." << std::endl;
+
+    Tree<std::string, int> tree;
+    std::map<std::string, int> expected;
+    for (int i = 0; i < 5000; i++) {
+        tree.insert("k" + std::to_string(i), i);
+        expected["k" + std::to_string(i)] = i;
+    }
+    auto old = tree;
+    auto oldExpected = expected;
+    for (int i = 0; i < 5000; i += 2) {
+        tree.del("k" + std::to_string(i));
+        expected.erase("k" + std::to_string(i));
+    }
+
+    // Neither thread writes anything shared, whichever version owns the
+    // leaf list
+    auto scan = [](const Tree<std::string, int>& t, const std::map<std::string, int>& contents) {
+        for (int round = 0; round < 20; round++) {
+            auto exp = contents.begin();
+            for (const auto& [key, val] : t) {
+                assert(key == exp->first && val == exp->second);
+                ++exp;
+            }
+            assert(exp == contents.end());
+        }
+    };
+    std::thread reader([&]() { scan(old, oldExpected); });
+    scan(tree, expected);
+    reader.join();
+
+    std::cout << "✓ concurrent snapshot reads test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "Running snapshot tests..." << std::endl;
+
+    testSnapshotsSurviveWrites();
+    testPathCopying();
+    testIsolatedTransactions();
+    testIteratorsAcrossWrites();
+    testConcurrentSnapshotReads();
+
+    std::cout << "\nAll snapshot tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <cassert>
+#include "radix/tree.hpp"
+#include "test_keys.hpp"
+
+// walk, walkPrefix and walkPath call a visitor on the stored keys and
+// values without copying them, and stop when it returns false. These
+// tests compare what they visit with a std::map.
+
+// Short keys, some with bytes above 0x7f
+const KeyGen kKeys{"ab/\xff", 0, 8};
+
+void testAgainstMap() {
+    std::cout << "Testing walks against std::map..." << std::endl;
+
+    std::mt19937 rng(23);
+    Tree<std::string, int> tree;
+    Map expected;
+    fillRandom(tree, expected, rng, kKeys, 3000);
+
+    Visited all;
+    tree.walk([&](KeyView<char> key, const int& val) {
+        all.push_back({std::string(key.begin(), key.end()), val});
+    });
+    assert(all == Visited(expected.begin(), expected.end()));
+
+    for (int i = 0; i < 500; i++) {
+        auto probe = kKeys(rng);
+
+        Visited under;
+        tree.walkPrefix(probe, [&](KeyView<char> key, const int& val) {
+            under.push_back({std::string(key.begin(), key.end()), val});
+        });
+        assert(under == entriesUnder(expected, probe));
+
+        Visited path;
+        tree.walkPath(probe, [&](KeyView<char> key, const int& val) {
+            path.push_back({std::string(key.begin(), key.end()), val});
+        });
+        assert(path == entriesAlong(expected, probe));
+    }
+
+    std::cout << "✓ std::map comparison test passed!" << std::endl;
+}
+
+void testEarlyStop() {
+    std::cout << "Testing walks that stop early..." << std::endl;
+
+    Tree<std::string, int> tree;
+    for (const char* key : {"", "a", "a/b", "a/b/c", "a/b/c/d", "b"}) {
+        tree.insert(key, 0);
+    }
+
+    // The first matching prefix, as an ACL check would want it
+    std::string first;
+    tree.walkPath(std::string("a/b/c/d/e"), [&](KeyView<char> key, const int&) {
+        if (key.empty()) {
+            return true;
+        }
+        first.assign(key.begin(), key.end());
+        return false;
+    });
+    assert(first == "a");
+
+    int seen = 0;
+    tree.walk([&](KeyView<char>, const int&) { return ++seen < 3; });
+    assert(seen == 3);
+
+    seen = 0;
+    tree.walkPrefix(std::string("a/"), [&](KeyView<char>, const int&) { return ++seen < 2; });
+    assert(seen == 2);
+
+    // Values are the stored ones, not copies
+    const int* stored = nullptr;
+    tree.walkPath(std::string("b"), [&](KeyView<char> key, const int& val) {
+        if (key == std::string("b")) {
+            stored = &val;
+        }
+    });
+    assert(stored && *stored == 0);
+
+    seen = 0;
+    tree.walkPrefix(std::string("c"), [&](KeyView<char>, const int&) { seen++; });
+    tree.walkPrefix(std::string("a/bx"), [&](KeyView<char>, const int&) { seen++; });
+    assert(seen == 0);
+
+    std::cout << "✓ early stop test passed!" << std::endl;
+}
+
+void testSnapshots() {
+    std::cout << "Testing walks over older snapshots..." << std::endl;
+
+    Tree<std::string, int> tree;
+    tree.insert("a", 1);
+    tree.insert("b", 2);
+    auto snapshot = tree;
+    tree.insert("ab", 3);
+    tree.del("b");
+
+    Visited old;
+    snapshot.walk([&](KeyView<char> key, const int& val) {
+        old.push_back({std::string(key.begin(), key.end()), val});
+    });
+    assert((old == Visited{{"a", 1}, {"b", 2}}));
+
+    Visited current;
+    tree.walkPrefix(std::string("a"), [&](KeyView<char> key, const int& val) {
+        current.push_back({std::string(key.begin(), key.end()), val});
+    });
+    assert((current == Visited{{"a", 1}, {"ab", 3}}));
+
+    // The live tree is written while a snapshot of it is being walked
+    auto latest = tree;
+    Visited during;
+    latest.walk([&](KeyView<char> key, const int& val) {
+        during.push_back({std::string(key.begin(), key.end()), val});
+        tree.insert("aa", 4);
+        tree.del("ab");
+    });
+    assert((during == Visited{{"a", 1}, {"ab", 3}}));
+
+    std::cout << "✓ snapshot test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "Running walk tests..." << std::endl;
+
+    testAgainstMap();
+    testEarlyStop();
+    testSnapshots();
+
+    std::cout << "\nAll walk tests passed!" << std::endl;
+    return 0;
+}